@@ -0,0 +1,216 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Measures how bulk writes through ExecuteBatchDml scale with the number of
+// statements per batch, and how a full export through PartitionQuery scales
+// with the number of partitions executed in parallel.
+//
+//   bulk_io_benchmark --rows=10000 --batch_sizes=1,10,100 \
+//       --partition_counts=1,2,4,8,16
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "google/cloud/spanner/client.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/latency_stats.h"
+
+ABSL_FLAG(int64_t, rows, 10000, "Rows written for each batch size");
+ABSL_FLAG(std::vector<std::string>, batch_sizes,
+          std::vector<std::string>({"1", "10", "100", "1000"}),
+          "INSERT statements per ExecuteBatchDml call to measure");
+ABSL_FLAG(std::vector<std::string>, partition_counts,
+          std::vector<std::string>({"1", "2", "4", "8", "16"}),
+          "max_partitions values to measure the export with");
+ABSL_FLAG(int, payload_bytes, 100, "Size of the payload column of each row");
+ABSL_FLAG(int, repetitions, 3, "Exports measured for each partition count");
+
+namespace spanner = ::google::cloud::spanner;
+using ::google::cloud::Status;
+using ::google::cloud::StatusOr;
+using ::spanner_emulator_fuzzer::EmulatorHarness;
+using ::spanner_emulator_fuzzer::LatencyStats;
+
+constexpr char kSchema[] =
+    "CREATE TABLE Items (Id INT64 NOT NULL, Payload STRING(MAX)) "
+    "PRIMARY KEY (Id)";
+constexpr char kExportQuery[] = "SELECT Id, Payload FROM Items";
+// Batch size used to load the table that is exported.
+constexpr int kExportBatchSize = 1000;
+
+struct BatchSizeResult {
+  LatencyStats latency;
+  int64_t rows = 0;
+  int64_t errors = 0;
+  absl::Duration elapsed;
+};
+
+// Writes the rows [0, --rows) in batches of batch_size single-row inserts,
+// one commit per batch.
+BatchSizeResult WriteRows(spanner::Client client, int batch_size) {
+  const int64_t total_rows = absl::GetFlag(FLAGS_rows);
+  const std::string payload(absl::GetFlag(FLAGS_payload_bytes), 'x');
+  BatchSizeResult result;
+  absl::Time start = absl::Now();
+  for (int64_t first = 0; first < total_rows; first += batch_size) {
+    std::vector<spanner::SqlStatement> statements;
+    for (int64_t id = first; id < first + batch_size && id < total_rows;
+         ++id) {
+      statements.emplace_back(
+          "INSERT INTO Items (Id, Payload) VALUES (@id, @payload)",
+          spanner::SqlStatement::ParamType{{"id", spanner::Value(id)},
+                                           {"payload", spanner::Value(payload)}});
+    }
+    absl::Time batch_start = absl::Now();
+    auto commit = client.Commit(
+        [&client, &statements](
+            spanner::Transaction txn) -> StatusOr<spanner::Mutations> {
+          auto batch = client.ExecuteBatchDml(std::move(txn), statements);
+          if (!batch) return batch.status();
+          if (!batch->status.ok()) return batch->status;
+          return spanner::Mutations{};
+        });
+    result.latency.Record(absl::Now() - batch_start);
+    if (commit) {
+      result.rows += statements.size();
+    } else {
+      ++result.errors;
+    }
+  }
+  result.elapsed = absl::Now() - start;
+  return result;
+}
+
+struct ExportResult {
+  LatencyStats latency;
+  int64_t rows = 0;
+  size_t partitions = 0;
+  int64_t errors = 0;
+  absl::Duration elapsed;
+};
+
+// Exports the table --repetitions times, each time executing every partition
+// on its own thread.
+ExportResult Export(spanner::Client client, int max_partitions) {
+  ExportResult result;
+  for (int i = 0; i < absl::GetFlag(FLAGS_repetitions); ++i) {
+    absl::Time start = absl::Now();
+    spanner::Transaction txn = spanner::MakeReadOnlyTransaction();
+    spanner::PartitionOptions options;
+    options.max_partitions = max_partitions;
+    auto partitions = client.PartitionQuery(
+        txn, spanner::SqlStatement(kExportQuery), options);
+    if (!partitions) {
+      ++result.errors;
+      continue;
+    }
+    result.partitions = partitions->size();
+
+    std::vector<int64_t> rows(partitions->size());
+    std::vector<Status> statuses(partitions->size());
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < partitions->size(); ++p) {
+      threads.emplace_back([&, p] {
+        for (auto const& row : client.ExecuteQuery((*partitions)[p])) {
+          if (!row) {
+            statuses[p] = row.status();
+            return;
+          }
+          ++rows[p];
+        }
+      });
+    }
+    for (std::thread& thread : threads) thread.join();
+    absl::Duration latency = absl::Now() - start;
+    result.latency.Record(latency);
+    result.elapsed += latency;
+    for (size_t p = 0; p < partitions->size(); ++p) {
+      if (!statuses[p].ok()) ++result.errors;
+      result.rows += rows[p];
+    }
+  }
+  return result;
+}
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  std::unique_ptr<EmulatorHarness> harness =
+      EmulatorHarness::Create(EmulatorHarness::Options());
+  if (!harness) {
+    return EXIT_FAILURE;
+  }
+
+  std::cout << absl::StrFormat("%10s %12s %8s  %s\n", "batch_size", "rows/s",
+                               "errors", "batch latency");
+  for (const std::string& batch_size_flag : absl::GetFlag(FLAGS_batch_sizes)) {
+    int batch_size = std::stoi(batch_size_flag);
+    if (batch_size < 1) {
+      std::cerr << "Batch sizes must be at least 1\n";
+      return EXIT_FAILURE;
+    }
+    // A fresh table per batch size, so every run inserts the same keys.
+    spanner::Database database = harness->NewDatabase();
+    Status status = harness->CreateDatabase(database, {kSchema});
+    if (!status.ok()) {
+      std::cerr << "Cannot create database: " << status.message() << "\n";
+      return EXIT_FAILURE;
+    }
+    BatchSizeResult result =
+        WriteRows(harness->MakeClient(database), batch_size);
+    std::cout << absl::StrFormat(
+        "%10d %12.1f %8d  %s\n", batch_size,
+        result.rows / absl::ToDoubleSeconds(result.elapsed), result.errors,
+        result.latency.Summary());
+    harness->DropDatabase(database);
+  }
+
+  spanner::Database database = harness->NewDatabase();
+  Status status = harness->CreateDatabase(database, {kSchema});
+  if (!status.ok()) {
+    std::cerr << "Cannot create database: " << status.message() << "\n";
+    return EXIT_FAILURE;
+  }
+  BatchSizeResult loaded =
+      WriteRows(harness->MakeClient(database), kExportBatchSize);
+  std::cout << "\nexporting " << loaded.rows << " rows\n"
+            << absl::StrFormat("%15s %11s %12s %8s  %s\n", "max_partitions",
+                               "partitions", "rows/s", "errors",
+                               "export latency");
+  for (const std::string& partitions_flag :
+       absl::GetFlag(FLAGS_partition_counts)) {
+    int max_partitions = std::stoi(partitions_flag);
+    ExportResult result = Export(harness->MakeClient(database), max_partitions);
+    double seconds = absl::ToDoubleSeconds(result.elapsed);
+    std::cout << absl::StrFormat(
+        "%15d %11d %12.1f %8d  %s\n", max_partitions, result.partitions,
+        seconds > 0 ? result.rows / seconds : 0.0, result.errors,
+        result.latency.Summary());
+  }
+  harness->DropDatabase(database);
+  return EXIT_SUCCESS;
+}
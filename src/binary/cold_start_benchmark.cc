@@ -0,0 +1,193 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Measures the cold start of a fresh process: loading the time zones the
+// emulator and the fuzz targets use, then starting and warming up the
+// emulator. Each run re-executes this binary, so absl's time zone cache is
+// always empty. Build it with and without --config=embedded_zoneinfo to
+// compare reading zoneinfo from ${TZDIR} with the zones compiled in.
+//
+//   cold_start_benchmark --runs=20
+//   cold_start_benchmark --runs=20 --start_emulator=false
+
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/latency_stats.h"
+#ifdef SPANNER_FUZZ_EMBEDDED_ZONEINFO
+#include "src/fuzz/utils/embedded_zoneinfo.h"
+#endif
+
+ABSL_FLAG(int, runs, 20, "Processes started");
+ABSL_FLAG(std::vector<std::string>, zones,
+          std::vector<std::string>({"America/Los_Angeles", "UTC",
+                                    "Europe/London", "Asia/Tokyo",
+                                    "Australia/Sydney"}),
+          "Time zones each process loads, America/Los_Angeles first since "
+          "it is Spanner's default time zone");
+ABSL_FLAG(bool, start_emulator, true,
+          "Start and warm up the emulator after loading the zones");
+ABSL_FLAG(bool, child, false,
+          "Internal: run one cold start and print its timings");
+
+extern char** environ;
+
+using ::spanner_emulator_fuzzer::EmulatorHarness;
+using ::spanner_emulator_fuzzer::LatencyStats;
+
+// Timings of one child, printed as nanoseconds on a single line.
+struct ColdStart {
+  absl::Duration zones;
+  absl::Duration emulator_startup;
+  absl::Duration warm_up;
+};
+
+int RunChild() {
+  ColdStart cold_start;
+  absl::Time start = absl::Now();
+  for (const std::string& name : absl::GetFlag(FLAGS_zones)) {
+    absl::TimeZone zone;
+    if (!absl::LoadTimeZone(name, &zone)) {
+      std::cerr << "Cannot load time zone " << name << "\n";
+      return EXIT_FAILURE;
+    }
+  }
+  cold_start.zones = absl::Now() - start;
+
+  if (absl::GetFlag(FLAGS_start_emulator)) {
+    std::unique_ptr<EmulatorHarness> harness =
+        EmulatorHarness::Create(EmulatorHarness::Options());
+    if (!harness) return EXIT_FAILURE;
+    cold_start.emulator_startup = harness->startup_duration();
+    cold_start.warm_up = harness->warm_up_duration();
+  }
+  std::cout << absl::ToInt64Nanoseconds(cold_start.zones) << " "
+            << absl::ToInt64Nanoseconds(cold_start.emulator_startup) << " "
+            << absl::ToInt64Nanoseconds(cold_start.warm_up) << std::endl;
+  return EXIT_SUCCESS;
+}
+
+// Starts this binary with --child and the same flags, and parses the
+// timings it prints.
+bool SpawnChild(const std::vector<std::string>& args, ColdStart* cold_start) {
+  std::vector<char*> argv;
+  for (const std::string& arg : args) {
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+
+  int fds[2];
+  if (pipe(fds) != 0) return false;
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+  posix_spawn_file_actions_addclose(&actions, fds[0]);
+  pid_t pid;
+  int error = posix_spawn(&pid, "/proc/self/exe", &actions, nullptr,
+                          argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  close(fds[1]);
+  if (error != 0) {
+    close(fds[0]);
+    return false;
+  }
+
+  std::string output;
+  char buffer[256];
+  ssize_t n;
+  while ((n = read(fds[0], buffer, sizeof(buffer))) > 0) {
+    output.append(buffer, n);
+  }
+  close(fds[0]);
+  int status;
+  if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) ||
+      WEXITSTATUS(status) != EXIT_SUCCESS) {
+    return false;
+  }
+
+  int64_t zones_ns, startup_ns, warm_up_ns;
+  if (std::sscanf(output.c_str(), "%" SCNd64 " %" SCNd64 " %" SCNd64, &zones_ns, &startup_ns,
+                  &warm_up_ns) != 3) {
+    return false;
+  }
+  cold_start->zones = absl::Nanoseconds(zones_ns);
+  cold_start->emulator_startup = absl::Nanoseconds(startup_ns);
+  cold_start->warm_up = absl::Nanoseconds(warm_up_ns);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  if (absl::GetFlag(FLAGS_child)) return RunChild();
+
+#ifdef SPANNER_FUZZ_EMBEDDED_ZONEINFO
+  std::cout << absl::StrFormat(
+      "zoneinfo: embedded, tzdata %s, %d zones\n",
+      spanner_emulator_fuzzer::kEmbeddedZoneInfoVersion,
+      spanner_emulator_fuzzer::kNumEmbeddedZones);
+#else
+  const char* tzdir = std::getenv("TZDIR");
+  std::cout << "zoneinfo: read from "
+            << (tzdir != nullptr ? tzdir : "/usr/share/zoneinfo") << "\n";
+#endif
+
+  std::vector<std::string> args = {
+      argv[0], "--child",
+      absl::StrCat("--zones=", absl::StrJoin(absl::GetFlag(FLAGS_zones), ",")),
+      absl::StrCat("--start_emulator=",
+                   absl::GetFlag(FLAGS_start_emulator) ? "true" : "false")};
+  LatencyStats process, zones, emulator_startup, warm_up;
+  int failures = 0;
+  for (int i = 0; i < absl::GetFlag(FLAGS_runs); ++i) {
+    ColdStart cold_start;
+    absl::Time start = absl::Now();
+    if (!SpawnChild(args, &cold_start)) {
+      ++failures;
+      continue;
+    }
+    process.Record(absl::Now() - start);
+    zones.Record(cold_start.zones);
+    emulator_startup.Record(cold_start.emulator_startup);
+    warm_up.Record(cold_start.warm_up);
+  }
+
+  std::cout << "process:          " << process.Summary() << "\n"
+            << "time zones:       " << zones.Summary() << "\n";
+  if (absl::GetFlag(FLAGS_start_emulator)) {
+    std::cout << "emulator startup: " << emulator_startup.Summary() << "\n"
+              << "warm-up:          " << warm_up.Summary() << "\n";
+  }
+  std::cout << "failed runs: " << failures << "\n";
+  return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
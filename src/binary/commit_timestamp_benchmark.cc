@@ -0,0 +1,190 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Measures commit throughput and latency of appends to a table with a commit
+// timestamp column, written with PENDING_COMMIT_TIMESTAMP() by a growing
+// number of concurrent writers. The table is built as a CreateTable proto and
+// rendered with toString, like the fuzz targets' tables.
+//
+//   commit_timestamp_benchmark --writers=1,4,16,64 --key_layout=timestamp_first
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/mutations.h"
+#include "src/fuzz/protobufs/create_table.pb.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_proto_to_string.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/latency_stats.h"
+
+ABSL_FLAG(std::vector<std::string>, writers,
+          std::vector<std::string>({"1", "4", "16", "64"}),
+          "Concurrent writer counts to measure");
+ABSL_FLAG(absl::Duration, duration, absl::Seconds(10),
+          "How long each writer count is measured");
+ABSL_FLAG(int, rows_per_commit, 1, "Rows inserted by each commit");
+ABSL_FLAG(int, payload_bytes, 100, "Size of the payload column of each row");
+ABSL_FLAG(std::string, key_layout, "timestamp_first",
+          "timestamp_first keys rows by (CommitTs, WriterId, Seq), the "
+          "append hotspot; writer_first by (WriterId, Seq, CommitTs)");
+
+namespace spanner = ::google::cloud::spanner;
+using ::google::cloud::Status;
+using ::google::cloud::StatusOr;
+using ::spanner_emulator_fuzzer::EmulatorHarness;
+using ::spanner_emulator_fuzzer::LatencyStats;
+using spanner_ddl::Column;
+using spanner_ddl::ColumnDataType;
+using spanner_ddl::CreateTable;
+
+Column* AddColumn(const std::string& name, ColumnDataType::ScalarType type,
+                  google::protobuf::RepeatedPtrField<Column>* columns) {
+  Column* column = columns->Add();
+  column->set_columnname(name);
+  ColumnDataType* data_type = column->mutable_columndatatype();
+  data_type->set_isarray(false);
+  data_type->set_scalartype(type);
+  data_type->set_length(0);
+  data_type->set_lengthtype(ColumnDataType::MAX);
+  column->set_isnotnull(true);
+  column->set_allowcommittimestamp(type == ColumnDataType::TIMESTAMP);
+  column->set_orientation(Column::ASC);
+  return column;
+}
+
+CreateTable EventsTable(bool timestamp_first) {
+  CreateTable table;
+  table.set_tablename("Events");
+  auto* keys = table.mutable_primarykeys();
+  if (timestamp_first) {
+    AddColumn("CommitTs", ColumnDataType::TIMESTAMP, keys);
+  }
+  AddColumn("WriterId", ColumnDataType::INT64, keys);
+  AddColumn("Seq", ColumnDataType::INT64, keys);
+  if (!timestamp_first) {
+    AddColumn("CommitTs", ColumnDataType::TIMESTAMP, keys);
+  }
+  AddColumn("Payload", ColumnDataType::STRING, table.mutable_nonprimarykeys())
+      ->set_isnotnull(false);
+  return table;
+}
+
+struct WriterCountResult {
+  LatencyStats latency;
+  std::atomic<int64_t> commits{0};
+  std::atomic<int64_t> errors{0};
+  // Attempts Commit reran after the emulator aborted the transaction, which
+  // the client library does transparently with backoff.
+  std::atomic<int64_t> aborts{0};
+};
+
+// Appends rows until deadline, one commit at a time. Latency is that of the
+// whole Commit call, including the reruns counted in aborts.
+void RunWriter(spanner::Client client, int64_t writer_id, absl::Time deadline,
+               WriterCountResult* result) {
+  const int rows_per_commit = absl::GetFlag(FLAGS_rows_per_commit);
+  const std::string payload(absl::GetFlag(FLAGS_payload_bytes), 'x');
+  int64_t seq = 0;
+  while (absl::Now() < deadline) {
+    std::vector<std::string> rows;
+    for (int i = 0; i < rows_per_commit; ++i) {
+      rows.push_back(absl::StrFormat("(%d, %d, PENDING_COMMIT_TIMESTAMP(), '%s')",
+                                     writer_id, seq++, payload));
+    }
+    spanner::SqlStatement insert(absl::StrCat(
+        "INSERT INTO Events (WriterId, Seq, CommitTs, Payload) VALUES ",
+        absl::StrJoin(rows, ", ")));
+
+    int attempts = 0;
+    absl::Time start = absl::Now();
+    auto commit = client.Commit(
+        [&client, &insert, &attempts](
+            spanner::Transaction txn) -> StatusOr<spanner::Mutations> {
+          ++attempts;
+          auto dml = client.ExecuteDml(std::move(txn), insert);
+          if (!dml) return dml.status();
+          return spanner::Mutations{};
+        });
+    result->latency.Record(absl::Now() - start);
+    result->aborts += attempts - 1;
+    if (commit) {
+      ++result->commits;
+    } else {
+      ++result->errors;
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  std::unique_ptr<EmulatorHarness> harness =
+      EmulatorHarness::Create(EmulatorHarness::Options());
+  if (!harness) {
+    return EXIT_FAILURE;
+  }
+  std::string schema =
+      toString(EventsTable(absl::GetFlag(FLAGS_key_layout) != "writer_first"));
+  std::cout << schema << "\n";
+
+  std::cout << absl::StrFormat("%8s %12s %12s %8s %8s  %s\n", "writers",
+                               "commits/s", "rows/s", "aborts", "errors",
+                               "latency");
+  for (const std::string& writers_flag : absl::GetFlag(FLAGS_writers)) {
+    int num_writers = std::stoi(writers_flag);
+
+    // A fresh table per writer count, so earlier runs do not grow it.
+    spanner::Database database = harness->NewDatabase();
+    Status status = harness->CreateDatabase(database, {schema});
+    if (!status.ok()) {
+      std::cerr << "Cannot create database: " << status.message() << "\n";
+      return EXIT_FAILURE;
+    }
+
+    WriterCountResult result;
+    absl::Time start = absl::Now();
+    absl::Time deadline = start + absl::GetFlag(FLAGS_duration);
+    std::vector<std::thread> writers;
+    for (int i = 0; i < num_writers; ++i) {
+      writers.emplace_back(RunWriter, harness->MakeClient(database), i,
+                           deadline, &result);
+    }
+    for (std::thread& writer : writers) writer.join();
+    double seconds = absl::ToDoubleSeconds(absl::Now() - start);
+
+    std::cout << absl::StrFormat(
+        "%8d %12.1f %12.1f %8d %8d  %s\n", num_writers,
+        result.commits.load() / seconds,
+        result.commits.load() * absl::GetFlag(FLAGS_rows_per_commit) / seconds,
+        result.aborts.load(), result.errors.load(), result.latency.Summary());
+    harness->DropDatabase(database);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,306 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Open-loop load generator for the emulator.
+//
+// Requests are issued on a fixed schedule at each offered load, independent of
+// how fast responses come back. Latency is measured from the time a request
+// was due to be sent, not from when it actually was, so a stalled emulator
+// shows up in the tail instead of silently slowing the load down (coordinated
+// omission). Requests go straight through async gRPC stubs and a completion
+// queue, so the client library's session pool does not throttle the load.
+//
+// For every offered load it prints the achieved rate and latency percentiles
+// of reads, queries and commits:
+//
+//   load_generator --qps=100,500,1000,2000 --duration=10s --streams=64
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/mutations.h"
+#include "google/spanner/v1/spanner.grpc.pb.h"
+#include "grpcpp/grpcpp.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/latency_stats.h"
+
+ABSL_FLAG(std::vector<std::string>, qps,
+          std::vector<std::string>({"100", "500", "1000", "2000"}),
+          "Offered loads to sweep, in requests per second");
+ABSL_FLAG(absl::Duration, duration, absl::Seconds(10),
+          "How long each offered load is held");
+ABSL_FLAG(int, streams, 64,
+          "Sessions the requests are spread over round-robin");
+ABSL_FLAG(int, cq_threads, 4, "Threads draining the completion queue");
+ABSL_FLAG(double, read_fraction, 0.4, "Fraction of requests that are reads");
+ABSL_FLAG(double, query_fraction, 0.4,
+          "Fraction of requests that are queries, the rest are commits");
+ABSL_FLAG(int64_t, key_space, 10000, "Rows seeded and addressed by requests");
+ABSL_FLAG(absl::Duration, rpc_deadline, absl::Seconds(30),
+          "Deadline of each request");
+
+namespace spanner = ::google::cloud::spanner;
+namespace spanner_proto = ::google::spanner::v1;
+using ::spanner_emulator_fuzzer::EmulatorHarness;
+using ::spanner_emulator_fuzzer::LatencyStats;
+
+enum Operation { kRead = 0, kQuery = 1, kCommit = 2, kNumOperations = 3 };
+
+const char* const kOperationNames[kNumOperations] = {"read", "query", "commit"};
+
+const char kSchema[] = R"sdl(
+    CREATE TABLE LoadTest (
+        Id    INT64 NOT NULL,
+        Value STRING(MAX)
+    ) PRIMARY KEY (Id))sdl";
+
+// One in-flight request. Deleted by the completion queue thread that receives
+// its completion.
+struct Call {
+  Operation operation;
+  absl::Time intended_start;
+  grpc::ClientContext context;
+  grpc::Status status;
+  spanner_proto::ResultSet result_set;
+  spanner_proto::CommitResponse commit_response;
+  std::unique_ptr<grpc::ClientAsyncResponseReader<spanner_proto::ResultSet>>
+      result_set_reader;
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReader<spanner_proto::CommitResponse>>
+      commit_reader;
+};
+
+// Results of holding one offered load.
+struct LoadLevel {
+  std::vector<LatencyStats> latencies =
+      std::vector<LatencyStats>(kNumOperations);
+  std::atomic<int64_t> errors{0};
+  std::atomic<int64_t> in_flight{0};
+};
+
+class LoadGenerator {
+ public:
+  LoadGenerator(std::shared_ptr<grpc::Channel> channel,
+                std::vector<std::string> sessions)
+      : stub_(spanner_proto::Spanner::NewStub(channel)),
+        sessions_(std::move(sessions)) {}
+
+  // Issues requests at qps for duration, then waits for all of them to finish.
+  void Run(double qps, absl::Duration duration, LoadLevel* level) {
+    std::vector<std::thread> drainers;
+    for (int i = 0; i < absl::GetFlag(FLAGS_cq_threads); ++i) {
+      drainers.emplace_back([this, level] { Drain(level); });
+    }
+
+    std::mt19937_64 random(42);
+    std::uniform_real_distribution<double> mix(0.0, 1.0);
+    std::uniform_int_distribution<int64_t> key(
+        0, absl::GetFlag(FLAGS_key_space) - 1);
+    double read_fraction = absl::GetFlag(FLAGS_read_fraction);
+    double query_fraction = absl::GetFlag(FLAGS_query_fraction);
+
+    absl::Duration interval = absl::Seconds(1) / qps;
+    absl::Time start = absl::Now();
+    int64_t total = static_cast<int64_t>(qps * absl::ToDoubleSeconds(duration));
+    for (int64_t i = 0; i < total; ++i) {
+      absl::Time intended_start = start + i * interval;
+      // Never wait for responses: if the schedule has slipped, send right away
+      // and let the latency carry the delay.
+      absl::SleepFor(intended_start - absl::Now());
+
+      double draw = mix(random);
+      Operation operation = draw < read_fraction ? kRead
+                            : draw < read_fraction + query_fraction ? kQuery
+                                                                     : kCommit;
+      Issue(operation, intended_start, sessions_[i % sessions_.size()],
+            key(random), level);
+    }
+
+    while (level->in_flight.load() > 0) {
+      absl::SleepFor(absl::Milliseconds(10));
+    }
+    cq_.Shutdown();
+    for (std::thread& drainer : drainers) {
+      drainer.join();
+    }
+  }
+
+ private:
+  void Issue(Operation operation, absl::Time intended_start,
+             const std::string& session, int64_t key, LoadLevel* level) {
+    auto* call = new Call;
+    call->operation = operation;
+    call->intended_start = intended_start;
+    call->context.set_deadline(
+        absl::ToChronoTime(absl::Now() + absl::GetFlag(FLAGS_rpc_deadline)));
+    ++level->in_flight;
+
+    switch (operation) {
+      case kRead: {
+        spanner_proto::ReadRequest request;
+        request.set_session(session);
+        request.set_table("LoadTest");
+        request.add_columns("Value");
+        request.mutable_key_set()->add_keys()->add_values()->set_string_value(
+            std::to_string(key));
+        call->result_set_reader = stub_->AsyncRead(&call->context, request, &cq_);
+        call->result_set_reader->Finish(&call->result_set, &call->status, call);
+        break;
+      }
+      case kQuery: {
+        spanner_proto::ExecuteSqlRequest request;
+        request.set_session(session);
+        request.set_sql("SELECT Value FROM LoadTest WHERE Id = @id");
+        (*request.mutable_params()->mutable_fields())["id"].set_string_value(
+            std::to_string(key));
+        (*request.mutable_param_types())["id"].set_code(spanner_proto::INT64);
+        call->result_set_reader =
+            stub_->AsyncExecuteSql(&call->context, request, &cq_);
+        call->result_set_reader->Finish(&call->result_set, &call->status, call);
+        break;
+      }
+      default: {
+        spanner_proto::CommitRequest request;
+        request.set_session(session);
+        request.mutable_single_use_transaction()->mutable_read_write();
+        auto* write = request.add_mutations()->mutable_insert_or_update();
+        write->set_table("LoadTest");
+        write->add_columns("Id");
+        write->add_columns("Value");
+        auto* row = write->add_values();
+        row->add_values()->set_string_value(std::to_string(key));
+        row->add_values()->set_string_value(absl::StrCat("value-", key));
+        call->commit_reader = stub_->AsyncCommit(&call->context, request, &cq_);
+        call->commit_reader->Finish(&call->commit_response, &call->status, call);
+        break;
+      }
+    }
+  }
+
+  void Drain(LoadLevel* level) {
+    void* tag;
+    bool ok;
+    while (cq_.Next(&tag, &ok)) {
+      std::unique_ptr<Call> call(static_cast<Call*>(tag));
+      level->latencies[call->operation].Record(absl::Now() -
+                                               call->intended_start);
+      if (!ok || !call->status.ok()) {
+        ++level->errors;
+      }
+      --level->in_flight;
+    }
+  }
+
+  std::unique_ptr<spanner_proto::Spanner::Stub> stub_;
+  std::vector<std::string> sessions_;
+  grpc::CompletionQueue cq_;
+};
+
+// Fills the table every request addresses.
+google::cloud::Status Seed(spanner::Client& client, int64_t key_space) {
+  constexpr int64_t kBatchSize = 1000;
+  for (int64_t first = 0; first < key_space; first += kBatchSize) {
+    auto builder =
+        spanner::InsertOrUpdateMutationBuilder("LoadTest", {"Id", "Value"});
+    for (int64_t id = first; id < first + kBatchSize && id < key_space; ++id) {
+      builder.EmplaceRow(id, absl::StrCat("value-", id));
+    }
+    auto commit = client.Commit(spanner::Mutations{builder.Build()});
+    if (!commit) return commit.status();
+  }
+  return google::cloud::Status();
+}
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  EmulatorHarness::Options options;
+  options.rpc_deadline = absl::GetFlag(FLAGS_rpc_deadline);
+  std::unique_ptr<EmulatorHarness> harness = EmulatorHarness::Create(options);
+  if (!harness) {
+    return EXIT_FAILURE;
+  }
+
+  spanner::Database database = harness->NewDatabase();
+  auto status = harness->CreateDatabase(database, {kSchema});
+  if (!status.ok()) {
+    std::cerr << "Cannot create database: " << status.message() << "\n";
+    return EXIT_FAILURE;
+  }
+  spanner::Client client = harness->MakeClient(database);
+  status = Seed(client, absl::GetFlag(FLAGS_key_space));
+  if (!status.ok()) {
+    std::cerr << "Cannot seed database: " << status.message() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel(
+      harness->connection_options().endpoint(),
+      grpc::InsecureChannelCredentials());
+  auto stub = spanner_proto::Spanner::NewStub(channel);
+  std::vector<std::string> sessions;
+  for (int i = 0; i < absl::GetFlag(FLAGS_streams); ++i) {
+    grpc::ClientContext context;
+    spanner_proto::CreateSessionRequest request;
+    request.set_database(database.FullName());
+    spanner_proto::Session session;
+    grpc::Status session_status =
+        stub->CreateSession(&context, request, &session);
+    if (!session_status.ok()) {
+      std::cerr << "Cannot create session: " << session_status.error_message()
+                << "\n";
+      return EXIT_FAILURE;
+    }
+    sessions.push_back(session.name());
+  }
+
+  std::cout << absl::StrFormat("%10s %10s %8s %8s  %s\n", "offered", "achieved",
+                               "errors", "op", "latency");
+  for (const std::string& qps_flag : absl::GetFlag(FLAGS_qps)) {
+    double qps = std::stod(qps_flag);
+    LoadLevel level;
+    LoadGenerator generator(channel, sessions);
+    absl::Time start = absl::Now();
+    generator.Run(qps, absl::GetFlag(FLAGS_duration), &level);
+    absl::Duration elapsed = absl::Now() - start;
+
+    int64_t completed = 0;
+    for (const LatencyStats& latency : level.latencies) {
+      completed += latency.count();
+    }
+    double achieved = completed / absl::ToDoubleSeconds(elapsed);
+    for (int op = 0; op < kNumOperations; ++op) {
+      std::cout << absl::StrFormat("%10.0f %10.1f %8d %8s  %s\n", qps, achieved,
+                                   level.errors.load(), kOperationNames[op],
+                                   level.latencies[op].Summary());
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,272 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Measures whether databases in one emulator instance slow each other down.
+// One table is generated from --seed as a CreateTable proto and rendered with
+// toString. For each --databases count N the benchmark creates N databases
+// holding that same table, and runs --workers_per_database threads of
+// read-write transactions against every database for --duration. Every
+// database has the same schema, so rows differ only in how many databases
+// are active. If databases shared no locks, per-database throughput would
+// stay flat as N grows until the machine runs out of cores.
+//
+//   multi_database_benchmark --databases=1,2,4,8,16 --workers_per_database=2
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "google/cloud/spanner/client.h"
+#include "src/fuzz/protobufs/create_table.pb.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_proto_to_string.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_validator.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_value_generator.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/latency_stats.h"
+
+ABSL_FLAG(std::vector<std::string>, databases,
+          std::vector<std::string>({"1", "2", "4", "8", "16"}),
+          "Numbers of concurrently active databases to measure");
+ABSL_FLAG(int, workers_per_database, 2,
+          "Threads running transactions against each database");
+ABSL_FLAG(absl::Duration, duration, absl::Seconds(10),
+          "How long each database count is measured");
+ABSL_FLAG(uint64_t, seed, 1, "Seed of the generated schema and values");
+ABSL_FLAG(int, max_columns, 6, "Most non-key columns of a generated table");
+
+namespace spanner = ::google::cloud::spanner;
+using ::google::cloud::Status;
+using ::google::cloud::StatusOr;
+using ::spanner_emulator_fuzzer::EmulatorHarness;
+using ::spanner_emulator_fuzzer::LatencyStats;
+using ::spanner_emulator_fuzzer::ValueGenerator;
+using spanner_ddl::Column;
+using spanner_ddl::ColumnDataType;
+using spanner_ddl::CreateTable;
+
+// Generated STRING and BYTES values are at most this long, and generated
+// bounded columns at least this long.
+constexpr int kMaxValueLength = 8;
+
+Column* AddColumn(const std::string& name, std::mt19937_64& rng,
+                  google::protobuf::RepeatedPtrField<Column>* columns) {
+  Column* column = columns->Add();
+  column->set_columnname(name);
+  ColumnDataType* data_type = column->mutable_columndatatype();
+  data_type->set_isarray(rng() % 4 == 0);
+  data_type->set_scalartype(static_cast<ColumnDataType::ScalarType>(
+      rng() % (ColumnDataType::ScalarType_MAX + 1)));
+  data_type->set_length(kMaxValueLength + rng() % 64);
+  data_type->set_lengthtype(rng() % 2 == 0 ? ColumnDataType::BOUND
+                                           : ColumnDataType::MAX);
+  column->set_isnotnull(rng() % 2 == 0);
+  column->set_allowcommittimestamp(
+      data_type->scalartype() == ColumnDataType::TIMESTAMP && rng() % 2 == 0);
+  column->set_orientation(rng() % 2 == 0 ? Column::ASC : Column::DESC);
+  return column;
+}
+
+// A table keyed by a leading INT64 Id, which the workers keep unique, plus
+// an optional second key column and up to --max_columns generated columns.
+CreateTable GenerateTable(uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  CreateTable table;
+  table.set_tablename("Items");
+  Column* id = table.add_primarykeys();
+  id->set_columnname("Id");
+  ColumnDataType* id_type = id->mutable_columndatatype();
+  id_type->set_isarray(false);
+  id_type->set_scalartype(ColumnDataType::INT64);
+  id_type->set_length(0);
+  id_type->set_lengthtype(ColumnDataType::MAX);
+  id->set_isnotnull(true);
+  id->set_allowcommittimestamp(false);
+  id->set_orientation(Column::ASC);
+  if (rng() % 2 == 0) {
+    // Arrays cannot be keys.
+    AddColumn("Key1", rng, table.mutable_primarykeys())
+        ->mutable_columndatatype()
+        ->set_isarray(false);
+  }
+  int columns = rng() % (absl::GetFlag(FLAGS_max_columns) + 1);
+  for (int i = 0; i < columns; ++i) {
+    AddColumn(absl::StrCat("Col", i), rng, table.mutable_nonprimarykeys());
+  }
+  return table;
+}
+
+// "INSERT INTO <table> (Id, ...) VALUES (<id>, ...)" with generated values
+// for every column but Id.
+std::string InsertRow(const CreateTable& table, int64_t id,
+                      ValueGenerator* generator) {
+  std::vector<std::string> names = {"Id"};
+  std::vector<std::string> values = {absl::StrCat(id)};
+  for (const auto* columns : {&table.primarykeys(), &table.nonprimarykeys()}) {
+    for (const Column& column : *columns) {
+      if (column.columnname() == "Id") continue;
+      names.push_back(column.columnname());
+      values.push_back(generator->literal(column));
+    }
+  }
+  return absl::StrFormat("INSERT INTO %s (%s) VALUES (%s)", table.tablename(),
+                         absl::StrJoin(names, ", "),
+                         absl::StrJoin(values, ", "));
+}
+
+struct DatabaseResult {
+  LatencyStats latency;
+  std::atomic<int64_t> commits{0};
+  std::atomic<int64_t> errors{0};
+};
+
+// Runs read-write transactions until deadline. Each one reads the row the
+// worker inserted last and inserts the next, so it takes both read and write
+// locks in its own database.
+void RunWorker(spanner::Client client, const CreateTable& table, int worker,
+               uint64_t seed, absl::Time deadline, DatabaseResult* result) {
+  ValueGenerator generator(seed, kMaxValueLength);
+  const int workers = absl::GetFlag(FLAGS_workers_per_database);
+  const std::string read = absl::StrCat(
+      "SELECT COUNT(*) FROM ", table.tablename(), " WHERE Id = @id");
+  for (int64_t id = worker; absl::Now() < deadline; id += workers) {
+    std::string insert = InsertRow(table, id, &generator);
+    absl::Time start = absl::Now();
+    auto commit = client.Commit(
+        [&](spanner::Transaction txn) -> StatusOr<spanner::Mutations> {
+          auto rows = client.ExecuteQuery(
+              txn, spanner::SqlStatement(
+                       read, {{"id", spanner::Value(id - workers)}}));
+          for (auto const& row : rows) {
+            if (!row) return row.status();
+          }
+          auto dml = client.ExecuteDml(txn, spanner::SqlStatement(insert));
+          if (!dml) return dml.status();
+          return spanner::Mutations{};
+        });
+    result->latency.Record(absl::Now() - start);
+    if (commit) {
+      ++result->commits;
+    } else {
+      ++result->errors;
+    }
+  }
+}
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  const uint64_t seed = absl::GetFlag(FLAGS_seed);
+  const int workers = absl::GetFlag(FLAGS_workers_per_database);
+
+  std::unique_ptr<EmulatorHarness> harness =
+      EmulatorHarness::Create(EmulatorHarness::Options());
+  if (!harness) {
+    return EXIT_FAILURE;
+  }
+  std::cout << "hardware threads: " << std::thread::hardware_concurrency()
+            << "\n";
+
+  const CreateTable table = GenerateTable(seed);
+  const std::string schema = toString(table);
+  if (spanner_emulator_fuzzer::validate(table) !=
+      spanner_emulator_fuzzer::DDLValidity::kValid) {
+    std::cerr << "Generated an invalid table: " << schema << "\n";
+    return EXIT_FAILURE;
+  }
+  std::cout << schema << "\n";
+
+  std::cout << absl::StrFormat("%9s %8s %12s %30s %8s %14s  %s\n",
+                               "databases", "threads", "commits/s",
+                               "per-database min/median/max", "errors",
+                               "create (mean)", "latency");
+  double baseline_per_database = 0;
+  for (const std::string& databases_flag : absl::GetFlag(FLAGS_databases)) {
+    int num_databases = std::stoi(databases_flag);
+    if (num_databases < 1) {
+      std::cerr << "Database counts must be at least 1\n";
+      return EXIT_FAILURE;
+    }
+
+    std::vector<spanner::Database> databases;
+    absl::Duration create_time;
+    for (int i = 0; i < num_databases; ++i) {
+      databases.push_back(harness->NewDatabase());
+      absl::Time start = absl::Now();
+      Status status = harness->CreateDatabase(databases.back(), {schema});
+      create_time += absl::Now() - start;
+      if (!status.ok()) {
+        std::cerr << "Cannot create database: " << status.message() << "\n";
+        return EXIT_FAILURE;
+      }
+    }
+
+    std::vector<std::unique_ptr<DatabaseResult>> results;
+    std::vector<std::thread> threads;
+    absl::Time start = absl::Now();
+    absl::Time deadline = start + absl::GetFlag(FLAGS_duration);
+    for (int i = 0; i < num_databases; ++i) {
+      results.push_back(std::make_unique<DatabaseResult>());
+      for (int w = 0; w < workers; ++w) {
+        threads.emplace_back(RunWorker, harness->MakeClient(databases[i]),
+                             std::cref(table), w,
+                             seed + i * workers + w, deadline,
+                             results.back().get());
+      }
+    }
+    for (std::thread& thread : threads) thread.join();
+    double seconds = absl::ToDoubleSeconds(absl::Now() - start);
+
+    LatencyStats latency;
+    std::vector<double> per_database;
+    int64_t commits = 0, errors = 0;
+    for (const auto& result : results) {
+      latency.Merge(result->latency);
+      per_database.push_back(result->commits.load() / seconds);
+      commits += result->commits.load();
+      errors += result->errors.load();
+    }
+    std::sort(per_database.begin(), per_database.end());
+    double median = per_database[per_database.size() / 2];
+    if (baseline_per_database == 0) baseline_per_database = median;
+    std::cout << absl::StrFormat(
+        "%9d %8d %12.1f %30s %8d %14s  %s\n", num_databases,
+        num_databases * workers, commits / seconds,
+        absl::StrFormat("%.1f/%.1f/%.1f (%.0f%%)", per_database.front(),
+                        median, per_database.back(),
+                        100 * median / baseline_per_database),
+        errors, absl::FormatDuration(create_time / num_databases),
+        latency.Summary());
+
+    for (const spanner::Database& database : databases) {
+      harness->DropDatabase(database);
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,166 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures how long it takes to give an input a fresh copy of a seeded
+// database, as a function of the database's size. Compares reseeding through
+// Commit with DatabaseSnapshot::RunIsolated and DatabaseSnapshot::Clone.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/mutations.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "src/fuzz/utils/database_snapshot.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/latency_stats.h"
+
+ABSL_FLAG(std::vector<std::string>, rows,
+          std::vector<std::string>({"100", "1000", "10000", "50000"}),
+          "Database sizes, in rows, to measure");
+ABSL_FLAG(int, iterations, 50, "Isolated runs measured per database size");
+ABSL_FLAG(int, clone_iterations, 3, "Clones measured per database size");
+
+namespace spanner = ::google::cloud::spanner;
+using ::google::cloud::Status;
+using ::google::cloud::StatusOr;
+using ::spanner_emulator_fuzzer::DatabaseSnapshot;
+using ::spanner_emulator_fuzzer::EmulatorHarness;
+using ::spanner_emulator_fuzzer::LatencyStats;
+
+const char kSchema[] = R"sdl(
+    CREATE TABLE Seed (
+        Id      INT64 NOT NULL,
+        Name    STRING(MAX),
+        Payload BYTES(MAX)
+    ) PRIMARY KEY (Id))sdl";
+
+// Writes rows [0, num_rows) in batches, as a harness reloading its seed data
+// for every input would.
+Status Seed(spanner::Client& client, int64_t num_rows) {
+  constexpr int64_t kBatchSize = 500;
+  for (int64_t first = 0; first < num_rows; first += kBatchSize) {
+    auto builder = spanner::InsertOrUpdateMutationBuilder(
+        "Seed", {"Id", "Name", "Payload"});
+    for (int64_t id = first; id < std::min(first + kBatchSize, num_rows);
+         ++id) {
+      builder.EmplaceRow(id, absl::StrCat("name-", id),
+                         spanner::Bytes(std::string(64, 'x')));
+    }
+    auto commit = client.Commit(spanner::Mutations{builder.Build()});
+    if (!commit) return commit.status();
+  }
+  return Status();
+}
+
+// A typical stateful input: an insert, an update of a seeded row and a point
+// read of it. None of it scans the table, so the cost of RunIsolated does not
+// grow with the database.
+Status SampleInput(spanner::Client& client, spanner::Transaction transaction) {
+  auto insert = client.ExecuteDml(
+      transaction, spanner::SqlStatement(
+                       "INSERT INTO Seed (Id, Name) VALUES (-1, 'input')"));
+  if (!insert) return insert.status();
+  auto update = client.ExecuteDml(
+      transaction,
+      spanner::SqlStatement("UPDATE Seed SET Name = 'changed' WHERE Id = 0"));
+  if (!update) return update.status();
+  auto rows = client.ExecuteQuery(
+      transaction, spanner::SqlStatement("SELECT Name FROM Seed WHERE Id = 0"));
+  for (auto const& row : rows) {
+    if (!row) return row.status();
+  }
+  return Status();
+}
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  std::unique_ptr<EmulatorHarness> harness =
+      EmulatorHarness::Create(EmulatorHarness::Options());
+  if (!harness) {
+    return EXIT_FAILURE;
+  }
+
+  std::cout << absl::StrFormat("%10s %14s %14s %14s %14s\n", "rows", "reseed",
+                               "isolated p50", "isolated p99", "clone p50");
+  for (const std::string& rows_flag : absl::GetFlag(FLAGS_rows)) {
+    int64_t num_rows = std::stoll(rows_flag);
+
+    spanner::Database database = harness->NewDatabase();
+    Status status = harness->CreateDatabase(database, {kSchema});
+    if (!status.ok()) {
+      std::cerr << "Cannot create database: " << status.message() << "\n";
+      return EXIT_FAILURE;
+    }
+    spanner::Client client = harness->MakeClient(database);
+
+    absl::Time start = absl::Now();
+    status = Seed(client, num_rows);
+    absl::Duration reseed = absl::Now() - start;
+    if (!status.ok()) {
+      std::cerr << "Cannot seed database: " << status.message() << "\n";
+      return EXIT_FAILURE;
+    }
+
+    StatusOr<DatabaseSnapshot> snapshot =
+        DatabaseSnapshot::Capture(harness.get(), database);
+    if (!snapshot) {
+      std::cerr << "Cannot capture snapshot: " << snapshot.status().message()
+                << "\n";
+      return EXIT_FAILURE;
+    }
+
+    LatencyStats isolated;
+    for (int i = 0; i < absl::GetFlag(FLAGS_iterations); ++i) {
+      start = absl::Now();
+      status = snapshot->RunIsolated(SampleInput);
+      isolated.Record(absl::Now() - start);
+      if (!status.ok()) {
+        std::cerr << "Isolated run failed: " << status.message() << "\n";
+        return EXIT_FAILURE;
+      }
+    }
+
+    LatencyStats clone;
+    for (int i = 0; i < absl::GetFlag(FLAGS_clone_iterations); ++i) {
+      start = absl::Now();
+      auto cloned = snapshot->Clone();
+      clone.Record(absl::Now() - start);
+      if (!cloned) {
+        std::cerr << "Clone failed: " << cloned.status().message() << "\n";
+        return EXIT_FAILURE;
+      }
+      harness->DropDatabase(*cloned);
+    }
+    harness->DropDatabase(database);
+
+    std::cout << absl::StrFormat(
+        "%10d %14s %14s %14s %14s\n", num_rows, absl::FormatDuration(reseed),
+        absl::FormatDuration(isolated.Percentile(50)),
+        absl::FormatDuration(isolated.Percentile(99)),
+        absl::FormatDuration(clone.Percentile(50)));
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,289 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Replays a traffic log captured with SPANNER_FUZZ_CAPTURE_FILE against a
+// fresh emulator, without the client library in between. Requests are sent as
+// captured through a generic gRPC stub, one call at a time in capture order,
+// so emulator regressions can be bisected and profiled without client-side
+// session pooling, retries or backoff in the measurements.
+//
+// Session names and transaction ids are assigned by the emulator, so they are
+// learnt from the responses of the replayed calls and substituted into the
+// requests that follow. Long-running operation polls are skipped, the
+// emulator completes schema changes before returning the operation.
+//
+//   SPANNER_FUZZ_CAPTURE_FILE=/tmp/traffic.log ./create_table_fuzz_test ...
+//   traffic_replay --log=/tmp/traffic.log
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "frontend/server/server.h"
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
+#include "grpcpp/generic/generic_stub.h"
+#include "grpcpp/grpcpp.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "src/fuzz/utils/latency_stats.h"
+#include "src/fuzz/utils/traffic_identifiers.h"
+#include "src/fuzz/utils/traffic_log.h"
+
+ABSL_FLAG(std::string, log, "", "Traffic log to replay");
+ABSL_FLAG(std::string, server_address, "localhost:1235",
+          "Address the replay emulator listens on");
+ABSL_FLAG(std::vector<std::string>, skip_methods,
+          {"/google.longrunning.Operations/"},
+          "Prefixes of the methods that are not replayed");
+ABSL_FLAG(absl::Duration, rpc_deadline, absl::Seconds(30),
+          "Deadline of each replayed call");
+
+namespace protobuf = ::google::protobuf;
+using ::google::spanner::emulator::frontend::Server;
+using ::spanner_emulator_fuzzer::CollectIdentifiers;
+using ::spanner_emulator_fuzzer::IdentifierMap;
+using ::spanner_emulator_fuzzer::LatencyStats;
+using ::spanner_emulator_fuzzer::RemapIdentifiers;
+using ::spanner_emulator_fuzzer::TrafficLogReader;
+using ::spanner_emulator_fuzzer::TrafficRecord;
+
+struct CapturedCall {
+  std::string method;
+  std::vector<std::string> requests;
+  std::vector<std::string> responses;
+};
+
+struct MethodStats {
+  LatencyStats latency;
+  int64_t errors = 0;
+  // Calls that returned a different number of messages than when captured.
+  int64_t diverged = 0;
+};
+
+// Returns the calls of the log in the order they were started, and the time
+// the captured traffic spanned.
+bool ReadCalls(const std::string& path, std::vector<CapturedCall>* calls,
+               absl::Duration* span) {
+  std::unique_ptr<TrafficLogReader> reader = TrafficLogReader::Open(path);
+  if (!reader) {
+    return false;
+  }
+  absl::flat_hash_map<uint64_t, size_t> call_index;
+  TrafficRecord record;
+  while (reader->Next(&record)) {
+    auto inserted = call_index.emplace(record.call_id, calls->size());
+    if (inserted.second) {
+      calls->push_back(CapturedCall{record.method, {}, {}});
+    }
+    CapturedCall& call = (*calls)[inserted.first->second];
+    if (record.kind == TrafficRecord::kRequest) {
+      call.requests.push_back(std::move(record.payload));
+    } else {
+      call.responses.push_back(std::move(record.payload));
+    }
+    *span = record.timestamp;
+  }
+  return true;
+}
+
+// Looks up "/package.Service/Method" in the descriptors linked into the
+// binary. The emulator links every service it implements.
+const protobuf::MethodDescriptor* FindMethod(const std::string& method) {
+  std::vector<std::string> parts =
+      absl::StrSplit(method, '/', absl::SkipEmpty());
+  if (parts.size() != 2) {
+    return nullptr;
+  }
+  const protobuf::ServiceDescriptor* service =
+      protobuf::DescriptorPool::generated_pool()->FindServiceByName(parts[0]);
+  return service == nullptr ? nullptr : service->FindMethodByName(parts[1]);
+}
+
+std::unique_ptr<protobuf::Message> NewMessage(
+    const protobuf::Descriptor* descriptor) {
+  return std::unique_ptr<protobuf::Message>(
+      protobuf::MessageFactory::generated_factory()
+          ->GetPrototype(descriptor)
+          ->New());
+}
+
+// Learns the identifiers the emulator assigned in the replayed responses.
+void LearnIdentifiers(const protobuf::Descriptor* response_type,
+                      const std::vector<std::string>& captured,
+                      const std::vector<std::string>& replayed,
+                      IdentifierMap* ids) {
+  for (size_t i = 0; i < captured.size() && i < replayed.size(); ++i) {
+    std::unique_ptr<protobuf::Message> before = NewMessage(response_type);
+    std::unique_ptr<protobuf::Message> after = NewMessage(response_type);
+    if (!before->ParseFromString(captured[i]) ||
+        !after->ParseFromString(replayed[i])) {
+      continue;
+    }
+    std::vector<std::string> before_ids;
+    std::vector<std::string> after_ids;
+    CollectIdentifiers(*before, &before_ids);
+    CollectIdentifiers(*after, &after_ids);
+    for (size_t j = 0; j < before_ids.size() && j < after_ids.size(); ++j) {
+      if (!before_ids[j].empty()) {
+        (*ids)[before_ids[j]] = after_ids[j];
+      }
+    }
+  }
+}
+
+// Sends the requests of one call and collects its responses. Unary and
+// streaming calls alike go through the generic streaming interface.
+grpc::Status SendCall(grpc::GenericStub* stub, const std::string& method,
+                      const std::vector<std::string>& requests,
+                      std::vector<std::string>* responses) {
+  grpc::CompletionQueue cq;
+  grpc::ClientContext context;
+  context.set_deadline(
+      absl::ToChronoTime(absl::Now() + absl::GetFlag(FLAGS_rpc_deadline)));
+  auto await = [&cq] {
+    void* tag;
+    bool ok = false;
+    return cq.Next(&tag, &ok) && ok;
+  };
+
+  std::unique_ptr<grpc::GenericClientAsyncReaderWriter> call =
+      stub->PrepareCall(&context, method, &cq);
+  call->StartCall(nullptr);
+  bool ok = await();
+  for (size_t i = 0; ok && i < requests.size(); ++i) {
+    grpc::Slice slice(requests[i]);
+    grpc::ByteBuffer buffer(&slice, 1);
+    call->Write(buffer, nullptr);
+    ok = await();
+  }
+  if (ok) {
+    call->WritesDone(nullptr);
+    ok = await();
+  }
+  while (ok) {
+    grpc::ByteBuffer buffer;
+    call->Read(&buffer, nullptr);
+    if (!await()) {
+      break;
+    }
+    std::vector<grpc::Slice> slices;
+    buffer.Dump(&slices);
+    std::string response;
+    for (const grpc::Slice& slice : slices) {
+      response.append(reinterpret_cast<const char*>(slice.begin()),
+                      slice.size());
+    }
+    responses->push_back(std::move(response));
+  }
+  grpc::Status status;
+  call->Finish(&status, nullptr);
+  await();
+  cq.Shutdown();
+  return status;
+}
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  std::vector<CapturedCall> calls;
+  absl::Duration captured_span;
+  if (!ReadCalls(absl::GetFlag(FLAGS_log), &calls, &captured_span)) {
+    std::cerr << "Cannot read traffic log " << absl::GetFlag(FLAGS_log)
+              << "\n";
+    return EXIT_FAILURE;
+  }
+
+  Server::Options server_options;
+  server_options.server_address = absl::GetFlag(FLAGS_server_address);
+  std::unique_ptr<Server> server = Server::Create(server_options);
+  if (!server) {
+    std::cerr << "Cannot start the emulator on "
+              << server_options.server_address << "\n";
+    return EXIT_FAILURE;
+  }
+  grpc::GenericStub stub(grpc::CreateChannel(
+      server_options.server_address, grpc::InsecureChannelCredentials()));
+
+  IdentifierMap ids;
+  std::map<std::string, MethodStats> stats;
+  int64_t skipped = 0;
+  absl::Time replay_start = absl::Now();
+  for (const CapturedCall& captured : calls) {
+    bool skip = false;
+    for (const std::string& prefix : absl::GetFlag(FLAGS_skip_methods)) {
+      skip = skip || absl::StartsWith(captured.method, prefix);
+    }
+    const protobuf::MethodDescriptor* method = FindMethod(captured.method);
+    if (skip || method == nullptr) {
+      ++skipped;
+      continue;
+    }
+
+    std::vector<std::string> requests;
+    for (const std::string& payload : captured.requests) {
+      std::unique_ptr<protobuf::Message> request =
+          NewMessage(method->input_type());
+      if (request->ParseFromString(payload)) {
+        RemapIdentifiers(ids, request.get());
+        requests.push_back(request->SerializeAsString());
+      } else {
+        requests.push_back(payload);
+      }
+    }
+
+    std::vector<std::string> responses;
+    absl::Time start = absl::Now();
+    grpc::Status status =
+        SendCall(&stub, captured.method, requests, &responses);
+    MethodStats& method_stats = stats[captured.method];
+    method_stats.latency.Record(absl::Now() - start);
+    if (!status.ok()) {
+      ++method_stats.errors;
+    }
+    if (responses.size() != captured.responses.size()) {
+      ++method_stats.diverged;
+    }
+    LearnIdentifiers(method->output_type(), captured.responses, responses,
+                     &ids);
+  }
+  absl::Duration replay_span = absl::Now() - replay_start;
+  server->Shutdown();
+
+  std::cout << absl::StrFormat(
+      "replayed %d calls in %s (captured over %s), skipped %d\n",
+      calls.size() - skipped, absl::FormatDuration(replay_span),
+      absl::FormatDuration(captured_span), skipped);
+  std::cout << absl::StrFormat("%-50s %8s %8s  %s\n", "method", "errors",
+                               "diverged", "latency");
+  for (const auto& entry : stats) {
+    std::cout << absl::StrFormat("%-50s %8d %8d  %s\n", entry.first,
+                                 entry.second.errors, entry.second.diverged,
+                                 entry.second.latency.Summary());
+  }
+  return EXIT_SUCCESS;
+}
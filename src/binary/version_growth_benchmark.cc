@@ -0,0 +1,229 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Quantifies how the emulator's multi-version storage grows when a small set
+// of hot rows is updated over and over. Updaters rewrite the rows as fast as
+// they can while readers do strong reads and exact-staleness reads at each
+// --staleness level. Every --sample_interval the benchmark prints the number
+// of versions written per key, the process' RSS and heap, and the read
+// latency of each staleness level during the interval. If old versions are
+// never collected, memory and read latency grow with the versions per key.
+//
+//   version_growth_benchmark --duration=30m --keys=10 --staleness=0s,1s,1m
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/keys.h"
+#include "google/cloud/spanner/mutations.h"
+#include "google/cloud/spanner/transaction.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/input_profile.h"
+#include "src/fuzz/utils/latency_stats.h"
+
+ABSL_FLAG(absl::Duration, duration, absl::Minutes(10), "How long to run");
+ABSL_FLAG(absl::Duration, sample_interval, absl::Seconds(10),
+          "Time between samples of memory and read latency");
+ABSL_FLAG(int64_t, keys, 10, "Hot rows the updaters rewrite");
+ABSL_FLAG(int, updaters, 4, "Concurrent updating threads");
+ABSL_FLAG(int, readers, 4,
+          "Concurrent reading threads, cycling through the staleness levels");
+ABSL_FLAG(std::vector<std::string>, staleness,
+          std::vector<std::string>({"0s", "1s", "10s", "1m"}),
+          "Exact staleness of the reads, 0s for strong reads");
+ABSL_FLAG(int, payload_bytes, 100, "Size of the value written by each update");
+
+namespace spanner = ::google::cloud::spanner;
+using ::google::cloud::Status;
+using ::spanner_emulator_fuzzer::EmulatorHarness;
+using ::spanner_emulator_fuzzer::LatencyStats;
+using ::spanner_emulator_fuzzer::MemoryUsage;
+
+const char kSchema[] = R"sdl(
+    CREATE TABLE Hot (
+        Id      INT64 NOT NULL,
+        Version INT64 NOT NULL,
+        Payload STRING(MAX)
+    ) PRIMARY KEY (Id))sdl";
+
+// Latency of the successful reads of one staleness level, and how many reads
+// failed.
+struct ReadLevel {
+  absl::Duration staleness;
+  std::string name;
+  LatencyStats latency;
+  std::atomic<int64_t> errors{0};
+};
+
+// Updates keys round-robin. Updater i of n writes versions i, i + n, i + 2n,
+// ..., so every committed version is written by exactly one updater.
+void RunUpdater(spanner::Client client, int updater, int updaters,
+                absl::Time deadline, std::atomic<int64_t>* updates) {
+  const int64_t keys = absl::GetFlag(FLAGS_keys);
+  const std::string payload(absl::GetFlag(FLAGS_payload_bytes), 'x');
+  for (int64_t version = updater; absl::Now() < deadline;
+       version += updaters) {
+    auto commit = client.Commit(spanner::Mutations{
+        spanner::InsertOrUpdateMutationBuilder("Hot",
+                                               {"Id", "Version", "Payload"})
+            .EmplaceRow(std::int64_t{version % keys}, version, payload)
+            .Build()});
+    if (commit) ++*updates;
+  }
+}
+
+void RunReader(spanner::Client client, int reader, absl::Time deadline,
+               std::vector<std::unique_ptr<ReadLevel>>* levels) {
+  for (size_t i = reader; absl::Now() < deadline; ++i) {
+    ReadLevel& level = *(*levels)[i % levels->size()];
+    spanner::Transaction::ReadOnlyOptions options;
+    if (level.staleness > absl::ZeroDuration()) {
+      options = spanner::Transaction::ReadOnlyOptions(
+          absl::ToChronoNanoseconds(level.staleness));
+    }
+    absl::Time start = absl::Now();
+    auto rows = client.Read(spanner::MakeReadOnlyTransaction(options), "Hot",
+                            spanner::KeySet::All(), {"Id", "Version"});
+    bool ok = true;
+    for (auto const& row : rows) {
+      if (!row) {
+        ok = false;
+        break;
+      }
+    }
+    if (ok) {
+      level.latency.Record(absl::Now() - start);
+    } else {
+      ++level.errors;
+    }
+  }
+}
+
+double Megabytes(int64_t bytes) { return bytes / (1024.0 * 1024.0); }
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+
+  std::unique_ptr<EmulatorHarness> harness =
+      EmulatorHarness::Create(EmulatorHarness::Options());
+  if (!harness) {
+    return EXIT_FAILURE;
+  }
+  spanner::Database database = harness->NewDatabase();
+  Status status = harness->CreateDatabase(database, {kSchema});
+  if (!status.ok()) {
+    std::cerr << "Cannot create database: " << status.message() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  std::vector<std::unique_ptr<ReadLevel>> levels;
+  for (const std::string& staleness_flag : absl::GetFlag(FLAGS_staleness)) {
+    auto level = std::make_unique<ReadLevel>();
+    if (!absl::ParseDuration(staleness_flag, &level->staleness)) {
+      std::cerr << "Invalid staleness " << staleness_flag << "\n";
+      return EXIT_FAILURE;
+    }
+    level->name = level->staleness > absl::ZeroDuration()
+                      ? absl::StrCat("stale ", staleness_flag)
+                      : "strong";
+    levels.push_back(std::move(level));
+  }
+
+  MemoryUsage initial = spanner_emulator_fuzzer::ReadMemoryUsage();
+  absl::Time start = absl::Now();
+  absl::Time deadline = start + absl::GetFlag(FLAGS_duration);
+  std::atomic<int64_t> updates{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < absl::GetFlag(FLAGS_updaters); ++i) {
+    threads.emplace_back(RunUpdater, harness->MakeClient(database), i,
+                         absl::GetFlag(FLAGS_updaters), deadline, &updates);
+  }
+  for (int i = 0; i < absl::GetFlag(FLAGS_readers); ++i) {
+    threads.emplace_back(RunReader, harness->MakeClient(database), i,
+                         deadline, &levels);
+  }
+
+  std::cout << absl::StrFormat("%8s %10s %10s %9s %9s", "elapsed", "updates",
+                               "versions", "rss MB", "heap MB");
+  for (const auto& level : levels) {
+    std::cout << absl::StrFormat("  %22s", level->name + " p50/p99/err");
+  }
+  std::cout << "\n";
+
+  // Read latency of each level in the first and the last interval.
+  std::vector<absl::Duration> first_p50(levels.size());
+  std::vector<absl::Duration> last_p50(levels.size());
+  MemoryUsage usage = initial;
+  for (bool first = true; absl::Now() < deadline; first = false) {
+    absl::SleepFor(std::min(absl::GetFlag(FLAGS_sample_interval),
+                            deadline - absl::Now()));
+    usage = spanner_emulator_fuzzer::ReadMemoryUsage();
+    int64_t total_updates = updates.load();
+    absl::Duration elapsed = absl::Trunc(absl::Now() - start, absl::Seconds(1));
+    std::cout << absl::StrFormat(
+        "%8s %10d %10.1f %9.1f %9.1f", absl::FormatDuration(elapsed),
+        total_updates,
+        static_cast<double>(total_updates) / absl::GetFlag(FLAGS_keys),
+        Megabytes(usage.rss_bytes), Megabytes(usage.heap_bytes));
+    for (size_t i = 0; i < levels.size(); ++i) {
+      LatencyStats interval = levels[i]->latency.TakeAndClear();
+      std::cout << absl::StrFormat(
+          "  %9s/%9s/%2d", absl::FormatDuration(interval.Percentile(50)),
+          absl::FormatDuration(interval.Percentile(99)),
+          levels[i]->errors.exchange(0));
+      if (first) first_p50[i] = interval.Percentile(50);
+      last_p50[i] = interval.Percentile(50);
+    }
+    std::cout << std::endl;
+  }
+  for (std::thread& thread : threads) thread.join();
+
+  double million_versions = updates.load() / 1e6;
+  std::cout << absl::StrFormat(
+      "\n%d versions of %d keys, RSS %+.1fMB, heap %+.1fMB",
+      updates.load(), absl::GetFlag(FLAGS_keys),
+      Megabytes(usage.rss_bytes - initial.rss_bytes),
+      Megabytes(usage.heap_bytes - initial.heap_bytes));
+  if (million_versions > 0) {
+    std::cout << absl::StrFormat(
+        " (%.1fMB RSS per million versions)",
+        Megabytes(usage.rss_bytes - initial.rss_bytes) / million_versions);
+  }
+  std::cout << "\n";
+  for (size_t i = 0; i < levels.size(); ++i) {
+    std::cout << absl::StrFormat("%s read p50: %s in the first interval, %s in "
+                                 "the last\n",
+                                 levels[i]->name,
+                                 absl::FormatDuration(first_p50[i]),
+                                 absl::FormatDuration(last_p50[i]));
+  }
+  return EXIT_SUCCESS;
+}
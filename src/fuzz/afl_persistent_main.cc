@@ -0,0 +1,75 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// AFL++ persistent-mode driver for the byte-level libFuzzer style fuzz
+// targets.
+//
+// Under AFL's default fork mode every execution pays the full emulator
+// startup. This driver instead runs many inputs per process with __AFL_LOOP,
+// reading each one from AFL's shared-memory test case buffer instead of a
+// file. It must be built with afl-clang-fast++ (--config=aflplusplus); with
+// any other compiler it falls back to running the inputs read from stdin.
+//
+// The fork server is deferred with __AFL_INIT until after the OSS-Fuzz setup,
+// which only loads time zone data. Everything else worth sharing lives in the
+// emulator, whose gRPC threads do not survive fork(), so the emulator is
+// started and warmed up by the first input of every forked child and then
+// reused for up to kPersistentIterations inputs.
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+
+#include "src/fuzz/oss_fuzz.h"
+
+#ifndef __AFL_FUZZ_TESTCASE_LEN
+ssize_t fuzz_len;
+unsigned char fuzz_buf[1024000];
+#define __AFL_FUZZ_TESTCASE_LEN fuzz_len
+#define __AFL_FUZZ_TESTCASE_BUF fuzz_buf
+#define __AFL_FUZZ_INIT() void sync(void);
+#define __AFL_LOOP(x) \
+  ((fuzz_len = read(0, fuzz_buf, sizeof(fuzz_buf))) > 0 ? 1 : 0)
+#define __AFL_INIT() sync()
+#endif
+
+__AFL_FUZZ_INIT();
+
+// Inputs run by one forked child before AFL replaces it with a fresh one.
+// High, since the emulator's state is reset by the harness between inputs.
+// Building with -DSPANNER_FUZZ_AFL_ITERATIONS=1 gives fork-mode behavior.
+#ifndef SPANNER_FUZZ_AFL_ITERATIONS
+#define SPANNER_FUZZ_AFL_ITERATIONS 100000
+#endif
+constexpr int kPersistentIterations = SPANNER_FUZZ_AFL_ITERATIONS;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size);
+
+int main(int argc, char** argv) {
+  #ifdef __OSS_FUZZ__
+    if (!spanner_emulator_fuzzer::DoOssFuzzInit()) { std::abort(); }
+  #endif
+  __AFL_INIT();
+
+  // Must be read after __AFL_INIT, which maps the shared memory.
+  unsigned char* buf = __AFL_FUZZ_TESTCASE_BUF;
+  while (__AFL_LOOP(kPersistentIterations)) {
+    LLVMFuzzerTestOneInput(buf, __AFL_FUZZ_TESTCASE_LEN);
+  }
+
+  return 0;
+}
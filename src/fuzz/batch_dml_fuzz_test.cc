@@ -0,0 +1,230 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "libprotobuf_mutator/src/libfuzzer/libfuzzer_macro.h"
+
+#include "src/fuzz/protobufs/create_table.pb.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_proto_to_string.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_validator.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_value_generator.h"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "src/fuzz/oss_fuzz.h"
+#include "src/fuzz/utils/deadline.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/fuzz_target.h"
+#include "src/fuzz/utils/harness_config.h"
+#include "src/fuzz/utils/input_profile.h"
+#include "src/fuzz/utils/latency_stats.h"
+#include "src/fuzz/utils/outcome_features.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "zetasql/base/logging.h"
+#include "google/cloud/spanner/client.h"
+
+namespace spanner = ::google::cloud::spanner;
+using ::google::cloud::Status;
+using ::google::cloud::StatusCode;
+using ::google::cloud::StatusOr;
+using spanner_ddl::CreateTable;
+using ::spanner_emulator_fuzzer::DDLValidity;
+using ::spanner_emulator_fuzzer::EmulatorHarness;
+using ::spanner_emulator_fuzzer::InputProfile;
+using ::spanner_emulator_fuzzer::InputRunner;
+using ::spanner_emulator_fuzzer::LatencyStats;
+using ::spanner_emulator_fuzzer::OutcomeFeatures;
+using ::spanner_emulator_fuzzer::ValueGenerator;
+
+// Each input commits one ExecuteBatchDml call of between 1 and
+// kMaxBatchStatements single-row inserts, the count picked from the input.
+constexpr int kMaxBatchStatements = 8;
+
+// Commit latency of batches that committed, by number of statements.
+// Printed as the "batch dml" report section.
+struct BatchDmlStats {
+  std::array<LatencyStats, kMaxBatchStatements + 1> commits;
+
+  std::string StatsString() const {
+    std::string out = absl::StrFormat("%10s %14s  %s\n", "statements",
+                                      "statements/s", "commit latency");
+    for (int size = 1; size <= kMaxBatchStatements; ++size) {
+      const LatencyStats& latency = commits[size];
+      if (latency.count() == 0) continue;
+      absl::StrAppendFormat(&out, "%10d %14.1f  %s\n", size,
+                            size / absl::ToDoubleSeconds(latency.Mean()),
+                            latency.Summary());
+    }
+    return out;
+  }
+};
+
+// What the batch returned on the commit attempt that finished last.
+struct BatchResult {
+  Status batch_status;
+  std::vector<int64_t> row_counts;
+};
+
+BatchDmlStats* CreateBatchDmlStats(EmulatorHarness* harness) {
+  auto* stats = new BatchDmlStats;
+  harness->AddReportSection("batch dml",
+                            [stats] { return stats->StatsString(); });
+  return stats;
+}
+
+// Counts the rows of the table with a strong read.
+StatusOr<int64_t> CountRows(spanner::Client client,
+                            const std::string& table_name) {
+  auto count = std::make_shared<int64_t>(0);
+  Status status = spanner_emulator_fuzzer::RunWithDeadline(
+      [client, table_name, count]() mutable {
+        auto rows = client.ExecuteQuery(spanner::SqlStatement(
+            absl::StrCat("SELECT COUNT(*) FROM ", table_name)));
+        for (auto const& row : spanner::StreamOf<std::tuple<int64_t>>(rows)) {
+          if (!row) return row.status();
+          *count = std::get<0>(*row);
+        }
+        return Status();
+      },
+      spanner_emulator_fuzzer::GetHarnessConfig().rpc_deadline);
+  if (!status.ok()) return status;
+  return *count;
+}
+
+// Creates the input's table and commits one batch of generated inserts. The
+// batch must report one row count per statement that ran, stop at the first
+// failing statement, and on commit leave exactly the reported rows in the
+// table; anything else aborts the process so the input is saved as a crash.
+int RunInput(const CreateTable& createTable, EmulatorHarness& harness,
+             BatchDmlStats* stats, OutcomeFeatures* features,
+             InputProfile* profile) {
+  try {
+    if (spanner_emulator_fuzzer::validate(createTable) != DDLValidity::kValid) {
+      return 0;
+    }
+    std::string createTableDDLStatement = toString(createTable);
+
+    spanner::Database database = harness.NewDatabase();
+    Status status;
+    {
+      InputProfile::ScopedPhase phase(profile, "create_database");
+      status = harness.CreateDatabase(database, {createTableDDLStatement});
+    }
+    if (!status.ok()) {
+      spanner_emulator_fuzzer::RecordOutcome(features, status);
+      return 0;
+    }
+
+    uint64_t seed = std::hash<std::string>()(createTableDDLStatement);
+    ValueGenerator generator(seed, spanner_emulator_fuzzer::kMaxValueLength);
+    std::vector<spanner::SqlStatement> statements;
+    int batch_size = 1 + seed % kMaxBatchStatements;
+    for (int i = 0; i < batch_size; ++i) {
+      statements.emplace_back(
+          spanner_emulator_fuzzer::insertStatement(createTable, 1, &generator));
+    }
+
+    spanner::Client client = harness.MakeClient(database);
+    auto result = std::make_shared<BatchResult>();
+    absl::Duration latency;
+    {
+      InputProfile::ScopedPhase phase(profile, "batch_dml");
+      absl::Time start = absl::Now();
+      status = spanner_emulator_fuzzer::RunWithDeadline(
+          [client, statements, result]() mutable {
+            return client.Commit([&client, &statements, &result](
+                    spanner::Transaction txn) -> StatusOr<spanner::Mutations> {
+                  auto batch =
+                      client.ExecuteBatchDml(std::move(txn), statements);
+                  if (!batch) return batch.status();
+                  result->batch_status = batch->status;
+                  result->row_counts.clear();
+                  for (const auto& stats : batch->stats) {
+                    result->row_counts.push_back(stats.row_count);
+                  }
+                  if (!batch->status.ok()) return batch->status;
+                  return spanner::Mutations{};
+                }).status();
+          },
+          spanner_emulator_fuzzer::GetHarnessConfig().rpc_deadline);
+      latency = absl::Now() - start;
+    }
+    // A timed out commit may still be writing result.
+    if (status.code() == StatusCode::kDeadlineExceeded) return 0;
+    spanner_emulator_fuzzer::RecordOutcome(features, status);
+
+    const std::vector<int64_t>& row_counts = result->row_counts;
+    if (!result->batch_status.ok() &&
+        row_counts.size() >= statements.size()) {
+      LOG(ERROR) << "Batch of " << statements.size() << " statements failed "
+                 << "with " << result->batch_status.message() << " but "
+                 << "reported " << row_counts.size() << " row counts";
+      std::abort();
+    }
+    if (status.ok()) {
+      stats->commits[batch_size].Record(latency);
+      int64_t reported = 0;
+      for (int64_t row_count : row_counts) reported += row_count;
+      InputProfile::ScopedPhase phase(profile, "count_rows");
+      auto rows = CountRows(client, createTable.tablename());
+      if (row_counts.size() != statements.size() ||
+          reported != batch_size || (rows && *rows != reported)) {
+        LOG(ERROR) << "Committed a batch of " << statements.size()
+                   << " single-row inserts that reported "
+                   << row_counts.size() << " row counts adding up to "
+                   << reported << " rows, and the table holds "
+                   << (rows ? absl::StrCat(*rows) : rows.status().message())
+                   << " rows";
+        std::abort();
+      }
+    }
+
+    InputProfile::ScopedPhase phase(profile, "drop_database");
+    harness.DropDatabase(database);
+    return 0;
+  } catch (std::exception const& ex) {
+    LOG(ERROR) << "Standard exception raised: " << ex.what();
+    return 1;
+  }
+}
+
+DEFINE_PROTO_FUZZER(const CreateTable& createTable) {
+  #ifdef __OSS_FUZZ__
+    static bool Initialized = spanner_emulator_fuzzer::DoOssFuzzInit();
+    if (!Initialized) { std::abort(); }
+  #endif
+
+  static EmulatorHarness* harness = EmulatorHarness::Default();
+  if (harness == nullptr) { std::abort(); }
+  static BatchDmlStats* batch_dml_stats = CreateBatchDmlStats(harness);
+  static OutcomeFeatures* outcome_features =
+      spanner_emulator_fuzzer::CreateOutcomeFeatures(harness);
+  static InputRunner runner(harness);
+
+  runner.Run(createTable, [&](InputProfile* profile) {
+    return RunInput(createTable, *harness, batch_dml_stats, outcome_features,
+                    profile);
+  });
+}
@@ -0,0 +1,137 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "libprotobuf_mutator/src/libfuzzer/libfuzzer_macro.h"
+
+#include "src/fuzz/protobufs/create_table.pb.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_proto_to_string.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_validator.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_value_generator.h"
+
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "src/fuzz/oss_fuzz.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/fuzz_target.h"
+#include "src/fuzz/utils/harness_config.h"
+#include "src/fuzz/utils/input_profile.h"
+#include "src/fuzz/utils/outcome_features.h"
+
+#include "zetasql/base/logging.h"
+#include "google/cloud/spanner/client.h"
+
+using ::google::cloud::spanner::Client;
+using ::google::cloud::spanner::Database;
+using spanner_ddl::CreateTable;
+using ::spanner_emulator_fuzzer::DDLValidity;
+using ::spanner_emulator_fuzzer::EmulatorHarness;
+using ::spanner_emulator_fuzzer::InputProfile;
+using ::spanner_emulator_fuzzer::InputRunner;
+using ::spanner_emulator_fuzzer::OutcomeFeatures;
+using ::spanner_emulator_fuzzer::ValueGenerator;
+
+// Writers inserting into the input's table at the same time, each committing
+// kCommitsPerWriter transactions of kRowsPerCommit rows.
+constexpr int kWriters = 4;
+constexpr int kCommitsPerWriter = 2;
+constexpr int kRowsPerCommit = 2;
+
+// Commits DML inserts from one writer, PENDING_COMMIT_TIMESTAMP() going into
+// every commit timestamp column. Returns the status of each commit.
+std::vector<google::cloud::Status> RunWriter(const CreateTable& createTable,
+                                             Client client, uint64_t seed) {
+  ValueGenerator generator(seed, spanner_emulator_fuzzer::kMaxValueLength);
+  std::vector<google::cloud::Status> statuses;
+  for (int i = 0; i < kCommitsPerWriter; ++i) {
+    std::string insert = spanner_emulator_fuzzer::insertStatement(
+        createTable, kRowsPerCommit, &generator);
+    statuses.push_back(spanner_emulator_fuzzer::CommitDml(
+        client, std::move(insert),
+        spanner_emulator_fuzzer::GetHarnessConfig().rpc_deadline));
+  }
+  return statuses;
+}
+
+// Creates the input's table, has several writers append to it concurrently
+// and drops it again, recording each step in profile and every commit result
+// in features. Tables the validator rejects are left to create_table_fuzz_test.
+int RunInput(const CreateTable& createTable, EmulatorHarness& harness,
+             OutcomeFeatures* features, InputProfile* profile) {
+  try {
+    if (spanner_emulator_fuzzer::validate(createTable) != DDLValidity::kValid) {
+      return 0;
+    }
+    std::string createTableDDLStatement = toString(createTable);
+
+    Database database = harness.NewDatabase();
+    google::cloud::Status status;
+    {
+      InputProfile::ScopedPhase phase(profile, "create_database");
+      status = harness.CreateDatabase(database, {createTableDDLStatement});
+    }
+    if (!status.ok()) {
+      features->Record(static_cast<int>(status.code()), status.message());
+      return 0;
+    }
+
+    Client client = harness.MakeClient(database);
+    uint64_t seed = std::hash<std::string>()(createTableDDLStatement);
+    std::vector<std::vector<google::cloud::Status>> results(kWriters);
+    {
+      InputProfile::ScopedPhase phase(profile, "concurrent_inserts");
+      std::vector<std::thread> writers;
+      for (int i = 0; i < kWriters; ++i) {
+        writers.emplace_back([&, i] {
+          results[i] = RunWriter(createTable, client, seed + i);
+        });
+      }
+      for (std::thread& writer : writers) writer.join();
+    }
+    for (const auto& writer_results : results) {
+      for (const google::cloud::Status& result : writer_results) {
+        spanner_emulator_fuzzer::RecordOutcome(features, result);
+      }
+    }
+
+    InputProfile::ScopedPhase phase(profile, "drop_database");
+    harness.DropDatabase(database);
+    return 0;
+  } catch (std::exception const& ex) {
+    LOG(ERROR) << "Standard exception raised: " << ex.what();
+    return 1;
+  }
+}
+
+DEFINE_PROTO_FUZZER(const CreateTable& createTable) {
+  #ifdef __OSS_FUZZ__
+    static bool Initialized = spanner_emulator_fuzzer::DoOssFuzzInit();
+    if (!Initialized) { std::abort(); }
+  #endif
+
+  static EmulatorHarness* harness = EmulatorHarness::Default();
+  if (harness == nullptr) { std::abort(); }
+  static OutcomeFeatures* outcome_features =
+      spanner_emulator_fuzzer::CreateOutcomeFeatures(harness);
+  static InputRunner runner(harness);
+
+  runner.Run(createTable, [&](InputProfile* profile) {
+    return RunInput(createTable, *harness, outcome_features, profile);
+  });
+}
@@ -18,100 +18,160 @@
 
 #include "src/fuzz/protobufs/create_table.pb.h"
 #include "src/fuzz/protobufs/spanner_ddl.pb.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_feature_stats.h"
 #include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_proto_to_string.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_validator.h"
 
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <stdexcept>
+#include "backend/schema/parser/ddl_parser.h"
 #include "src/fuzz/oss_fuzz.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/fuzz_target.h"
+#include "src/fuzz/utils/harness_config.h"
+#include "src/fuzz/utils/input_profile.h"
+#include "src/fuzz/utils/outcome_features.h"
+#include "src/fuzz/utils/statement_result_cache.h"
 
 #include "zetasql/base/logging.h"
-#include "frontend/server/server.h"
-#include "google/cloud/spanner/client.h"
-#include "google/cloud/spanner/create_instance_request_builder.h"
-#include "google/cloud/spanner/database_admin_client.h"
-#include "google/cloud/spanner/instance_admin_client.h"
-
-using ::google::spanner::emulator::frontend::Server;
-using ::google::cloud::future;
-using ::google::cloud::StatusOr;
-using ::google::cloud::spanner::DatabaseAdminClient;
-using ::google::cloud::spanner::v0::ConnectionOptions;
-using spanner_ddl::CreateTable;
-
-const std::string server_address = "localhost:1234";
-
-DEFINE_PROTO_FUZZER(const CreateTable& createTable) {
-  #ifdef __OSS_FUZZ__
-    static bool Initialized = spanner_emulator_fuzzer::DoOssFuzzInit();
-    if (!Initialized) { std::abort(); }
-  #endif
 
-  Server::Options options;
-  options.server_address = server_address;
-  std::unique_ptr<Server> server = Server::Create(options);
-  if (!server) {
-    return EXIT_FAILURE;
+using ::google::cloud::spanner::Database;
+using spanner_ddl::CreateTable;
+using ::spanner_emulator_fuzzer::DDLValidationStats;
+using ::spanner_emulator_fuzzer::DDLValidity;
+using ::spanner_emulator_fuzzer::EmulatorHarness;
+using ::spanner_emulator_fuzzer::InputProfile;
+using ::spanner_emulator_fuzzer::InputRunner;
+using ::spanner_emulator_fuzzer::OutcomeFeatures;
+using ::spanner_emulator_fuzzer::StatementResult;
+using ::spanner_emulator_fuzzer::StatementResultCache;
+
+// Returns the cache of emulator results for rendered statements, or nullptr
+// if it is disabled.
+StatementResultCache* CreateResultCache(EmulatorHarness* harness) {
+  const auto& config = spanner_emulator_fuzzer::GetHarnessConfig();
+  if (config.result_cache_entries <= 0) {
+    return nullptr;
   }
+  auto* cache = new StatementResultCache(config.result_cache_entries,
+                                         config.result_cache_bytes);
+  harness->AddReportSection("result cache",
+                            [cache] { return cache->StatsString(); });
+  return cache;
+}
 
-  LOG(INFO) << "Server Up, Executing Test Query";
+// Returns the counts of how inputs were classified by the validator. They are
+// reported with the harness statistics, next to the features of the inputs.
+DDLValidationStats* CreateValidationStats(EmulatorHarness* harness) {
+  auto* stats = new DDLValidationStats;
+  harness->AddReportSection("ddl validation",
+                            [stats] { return stats->StatsString(); });
+  harness->AddReportSection("generated features", [] {
+    return spanner_emulator_fuzzer::ddlFeatureStats().StatsString();
+  });
+  return stats;
+}
 
+// Returns whether a statement the validator rejected is still sent to the
+// emulator. Decided by the statement, so an input always takes the same path.
+bool SampleInvalidStatement(const std::string& statement) {
+  return std::hash<std::string>()(statement) % 100 <
+         spanner_emulator_fuzzer::GetHarnessConfig().invalid_sample_percent;
+}
+
+// Creates a database from a single input's table in the shared emulator and
+// drops it again, recording each step in profile. Statements found in cache
+// are not sent to the emulator again, and statements known to be invalid
+// only go through the emulator's DDL parser unless sampled. Every result is
+// recorded in features.
+int RunInput(const CreateTable& createTable, EmulatorHarness& harness,
+             StatementResultCache* cache, DDLValidationStats* validation,
+             OutcomeFeatures* features, InputProfile* profile) {
   try {
-    // This is the connection to the emulator.
-    ConnectionOptions emulator_connection;
-    emulator_connection.set_endpoint(server_address)
-        .set_credentials(grpc::InsecureChannelCredentials());
-
-    // First we create an instance to create our database on.
-    google::cloud::spanner::Instance instance("emulator", "emulator");
-    google::cloud::spanner::InstanceAdminClient instance_client(
-        google::cloud::spanner::MakeInstanceAdminConnection(
-            emulator_connection));
-
-    auto instance_or = instance_client.CreateInstance(
-            google::cloud::spanner::CreateInstanceRequestBuilder(instance,
-                                                                 "emulator")
-                .SetDisplayName("emulator")
-                .SetNodeCount(1)
-                .SetLabels({{"label-key", "label-value"}})
-                .Build())
-                .get();
-    if (!instance_or) {
-      throw std::runtime_error(instance_or.status().message());
+    std::string createTableDDLStatement = toString(createTable);
+    recordFeatures(createTable);
+
+    DDLValidity validity = spanner_emulator_fuzzer::validate(createTable);
+    validation->record(validity);
+    if (validity != DDLValidity::kValid &&
+        !SampleInvalidStatement(createTableDDLStatement)) {
+        InputProfile::ScopedPhase phase(profile, "parse_only");
+        auto parsed = google::spanner::emulator::backend::ddl::ParseDDLStatement(
+            createTableDDLStatement);
+        features->Record(static_cast<int>(parsed.status().code()),
+            parsed.status().message());
+        return 0;
     }
-    LOG(INFO) << "Created instance [" << instance << "]";
 
-    // Then we create a simple database.
-    google::cloud::spanner::Database database(instance, "test-db");
-
-    std::string createTableDDLStatement = toString(createTable);
+    const StatementResult* cached = cache == nullptr ?
+        nullptr : cache->Lookup(createTableDDLStatement);
+    if (cached != nullptr) {
+        InputProfile::ScopedPhase phase(profile, "result_cache_hit");
+        features->Record(cached->status_code, cached->message);
+        return 0;
+    }
 
-    auto admin_client =
-        DatabaseAdminClient(google::cloud::spanner::MakeDatabaseAdminConnection(
-            emulator_connection));
-    try {
-        auto db_or =
-        admin_client.CreateDatabase(database, {createTableDDLStatement})
-            .get();
-        if (!db_or) throw std::runtime_error(db_or.status().message());
+    Database database = harness.NewDatabase();
 
-    } catch (std::exception const& ex) {
+    google::cloud::Status status;
+    {
+        InputProfile::ScopedPhase phase(profile, "create_database");
+        status = harness.CreateDatabase(database, {createTableDDLStatement});
+    }
+    // A timeout says nothing about the statement, so it is neither a
+    // feature nor cached, and is retried next time.
+    if (status.code() != google::cloud::StatusCode::kDeadlineExceeded) {
+        features->Record(static_cast<int>(status.code()), status.message());
+        if (cache != nullptr) {
+            cache->Insert(createTableDDLStatement, StatementResult{
+                static_cast<int>(status.code()), status.message()});
+        }
+    }
+    if (validity != DDLValidity::kValid && status.ok()) {
+        validation->recordMisprediction();
+        LOG(WARNING) << "Emulator accepted a statement classified as "
+                     << spanner_emulator_fuzzer::validityName(validity) << ": "
+                     << createTableDDLStatement;
+    }
+    if (!status.ok()) {
         LOG(INFO) << "Failed to create table with the following DDL statement:";
         LOG(INFO) << createTableDDLStatement;
+        return 0;
     }
-    
+
     LOG(INFO) << "Created database [" << database << "]";
     LOG(INFO) << "Ran following statement: " << createTableDDLStatement;
 
+    // Dropping the database keeps the emulator from accumulating one
+    // database per input.
+    InputProfile::ScopedPhase phase(profile, "drop_database");
+    harness.DropDatabase(database);
 
     return 0;
   } catch (std::exception const& ex) {
     LOG(ERROR) << "Standard exception raised: " << ex.what();
     return 1;
   }
+}
 
-  server->Shutdown();
+DEFINE_PROTO_FUZZER(const CreateTable& createTable) {
+  #ifdef __OSS_FUZZ__
+    static bool Initialized = spanner_emulator_fuzzer::DoOssFuzzInit();
+    if (!Initialized) { std::abort(); }
+  #endif
 
-  return 0;  
+  static EmulatorHarness* harness = EmulatorHarness::Default();
+  if (harness == nullptr) { std::abort(); }
+  static StatementResultCache* result_cache = CreateResultCache(harness);
+  static DDLValidationStats* validation_stats = CreateValidationStats(harness);
+  static OutcomeFeatures* outcome_features =
+      spanner_emulator_fuzzer::CreateOutcomeFeatures(harness);
+  static InputRunner runner(harness);
+
+  runner.Run(createTable, [&](InputProfile* profile) {
+    return RunInput(createTable, *harness, result_cache, validation_stats,
+                    outcome_features, profile);
+  });
 }
-
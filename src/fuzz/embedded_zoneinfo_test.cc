@@ -0,0 +1,58 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "src/fuzz/utils/embedded_zoneinfo.h"
+
+#include <cstdlib>
+#include <string>
+
+#include "absl/time/civil_time.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+using ::spanner_emulator_fuzzer::EmbeddedZone;
+using ::spanner_emulator_fuzzer::FindEmbeddedZone;
+using ::spanner_emulator_fuzzer::kEmbeddedZones;
+using ::spanner_emulator_fuzzer::kNumEmbeddedZones;
+
+TEST(EmbeddedZoneInfo, FindsZonesByName) {
+    ASSERT_GT(kNumEmbeddedZones, 0);
+    const EmbeddedZone* zone = FindEmbeddedZone("America/Los_Angeles");
+    ASSERT_NE(zone, nullptr);
+    EXPECT_EQ(std::string(zone->data, 4), "TZif");
+
+    EXPECT_EQ(FindEmbeddedZone("America/Los_Angele"), nullptr);
+    EXPECT_EQ(FindEmbeddedZone("America/Los_Angeles2"), nullptr);
+    EXPECT_EQ(FindEmbeddedZone(""), nullptr);
+
+    for (size_t i = 0; i < kNumEmbeddedZones; ++i) {
+        EXPECT_EQ(FindEmbeddedZone(kEmbeddedZones[i].name),
+            &kEmbeddedZones[i]);
+    }
+}
+
+TEST(EmbeddedZoneInfo, LoadsZonesWithoutTzdir) {
+    setenv("TZDIR", "/nonexistent", 1);
+
+    absl::TimeZone los_angeles;
+    ASSERT_TRUE(absl::LoadTimeZone("America/Los_Angeles", &los_angeles));
+    absl::Time time = absl::FromCivil(absl::CivilSecond(2020, 7, 1, 12, 0, 0),
+        absl::UTCTimeZone());
+    EXPECT_EQ(absl::ToCivilHour(time, los_angeles),
+        absl::CivilHour(2020, 7, 1, 5));
+
+    absl::TimeZone missing;
+    EXPECT_FALSE(absl::LoadTimeZone("Not/A_Zone", &missing));
+}
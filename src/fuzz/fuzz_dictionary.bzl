@@ -0,0 +1,56 @@
+#
+# Copyright 2020 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Rules for generating libFuzzer dictionaries."""
+
+# The JavaCC grammar compiled by the emulator's javacc_parser rule.
+EMULATOR_DDL_GRAMMAR = "@com_google_cloud_spanner_emulator//backend/schema/parser:ddl_parser.jjt"
+
+# ZetaSQL's table of reserved and non-reserved keywords.
+ZETASQL_KEYWORDS = "@com_google_zetasql//zetasql/parser:keywords.cc"
+
+def fuzz_dictionary(
+        name,
+        fuzz_target,
+        grammars = [EMULATOR_DDL_GRAMMAR],
+        zetasql_keywords = [ZETASQL_KEYWORDS],
+        extra_dicts = [],
+        **kwargs):
+    """Generates <fuzz_target>.dict next to a fuzz target.
+
+    libFuzzer and OSS-Fuzz pick up a dictionary named after the target binary,
+    so the output only needs to be copied alongside it.
+
+    Args:
+      name: Name of the rule.
+      fuzz_target: Name of the fuzz target binary the dictionary is for.
+      grammars: JavaCC grammars to take token literals from.
+      zetasql_keywords: ZetaSQL keywords.cc files to take keywords from.
+      extra_dicts: Hand written .dict files to merge in.
+      **kwargs: Passed through to the underlying genrule.
+    """
+    args = ["--grammar=$(location %s)" % src for src in grammars]
+    args += ["--zetasql_keywords=$(location %s)" % src for src in zetasql_keywords]
+    args += ["--extra=$(location %s)" % src for src in extra_dicts]
+    native.genrule(
+        name = name,
+        srcs = grammars + zetasql_keywords + extra_dicts,
+        outs = [fuzz_target + ".dict"],
+        cmd = "$(location //src/fuzz/tools:generate_fuzz_dictionary) " +
+              " ".join(args) + " --output=$@",
+        tools = ["//src/fuzz/tools:generate_fuzz_dictionary"],
+        **kwargs
+    )
@@ -0,0 +1,438 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "src/fuzz/oss_fuzz.h"
+#include "src/fuzz/utils/deadline.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/fuzz_target.h"
+#include "src/fuzz/utils/harness_config.h"
+#include "src/fuzz/utils/input_profile.h"
+
+#include "zetasql/base/logging.h"
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/keys.h"
+#include "google/cloud/spanner/mutations.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+
+namespace spanner = ::google::cloud::spanner;
+using ::google::cloud::Status;
+using ::spanner_emulator_fuzzer::EmulatorHarness;
+using ::spanner_emulator_fuzzer::InputProfile;
+using ::spanner_emulator_fuzzer::InputRunner;
+
+// Spanner's limits on a single STRING and BYTES value.
+constexpr int64_t kMaxStringLength = 2621440;
+constexpr int64_t kMaxBytesLength = 10485760;
+// Inputs are repeated up to 2^15 times, so a few KB reach the limits.
+constexpr int kMaxRepeatShift = 0xf;
+// STRING array elements are cut from the value in pieces of this size.
+constexpr int64_t kArrayElementLength = 64;
+
+const char kSchema[] = R"sdl(
+    CREATE TABLE LargeValues (
+        Id         INT64 NOT NULL,
+        Text       STRING(MAX),
+        Blob       BYTES(MAX),
+        TextArray  ARRAY<STRING(MAX)>,
+        Int64Array ARRAY<INT64>
+    ) PRIMARY KEY (Id))sdl";
+
+// The first input byte shapes the row: the low four bits how often the rest
+// of the input is repeated, the high four which columns are written.
+struct RowShape {
+  explicit RowShape(absl::string_view input)
+      : payload(input.substr(input.empty() ? 0 : 1)),
+        repeat(int64_t{1}
+               << (input.empty() ? 0 : input[0] & kMaxRepeatShift)),
+        columns(input.empty() ? 0 : (static_cast<uint8_t>(input[0]) >> 4)) {}
+
+  int64_t Length(int64_t limit) const {
+    return std::min(static_cast<int64_t>(payload.size()) * repeat, limit);
+  }
+  bool text() const { return columns & 1; }
+  bool blob() const { return columns & 2; }
+  bool text_array() const { return columns & 4; }
+  bool int64_array() const { return columns & 8; }
+
+  absl::string_view payload;
+  int64_t repeat;
+  int columns;
+};
+
+// Iterates over the payload repeated until length characters, so spanner::Bytes
+// encodes the repeated input straight from the fuzzer's buffer.
+class RepeatingIterator {
+ public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = char;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const char*;
+  using reference = const char&;
+
+  RepeatingIterator(absl::string_view payload, int64_t position)
+      : payload_(payload), position_(position) {}
+
+  reference operator*() const {
+    return payload_[position_ % payload_.size()];
+  }
+  RepeatingIterator& operator++() {
+    ++position_;
+    return *this;
+  }
+  RepeatingIterator operator++(int) {
+    RepeatingIterator previous = *this;
+    ++position_;
+    return previous;
+  }
+  bool operator==(const RepeatingIterator& other) const {
+    return position_ == other.position_;
+  }
+  bool operator!=(const RepeatingIterator& other) const {
+    return position_ != other.position_;
+  }
+
+ private:
+  absl::string_view payload_;
+  int64_t position_;
+};
+
+spanner::Bytes MakeBlob(const RowShape& shape) {
+  int64_t length = shape.Length(kMaxBytesLength);
+  return spanner::Bytes(RepeatingIterator(shape.payload, 0),
+                        RepeatingIterator(shape.payload, length));
+}
+
+// STRING values must be valid UTF-8, so the payload is folded into printable
+// ASCII while it is repeated into the value, in a single pass.
+std::string MakeText(const RowShape& shape) {
+  std::string text(shape.Length(kMaxStringLength), ' ');
+  for (size_t i = 0; i < text.size(); ++i) {
+    uint8_t c = shape.payload[i % shape.payload.size()];
+    text[i] = ' ' + c % 95;
+  }
+  return text;
+}
+
+std::vector<std::string> MakeTextArray(const std::string& text) {
+  std::vector<std::string> elements;
+  for (size_t i = 0; i < text.size(); i += kArrayElementLength) {
+    elements.push_back(text.substr(i, kArrayElementLength));
+  }
+  return elements;
+}
+
+std::vector<std::int64_t> MakeInt64Array(const RowShape& shape) {
+  std::vector<std::int64_t> elements(shape.Length(kMaxBytesLength) / 8);
+  for (size_t i = 0; i < elements.size(); ++i) {
+    uint64_t element = 0;
+    for (int byte = 0; byte < 8; ++byte) {
+      element = (element << 8) |
+                static_cast<uint8_t>(
+                    shape.payload[(i * 8 + byte) % shape.payload.size()]);
+    }
+    elements[i] = static_cast<std::int64_t>(element);
+  }
+  return elements;
+}
+
+// Sizes of a row's values, to compare what was written with what was read.
+struct RowSizes {
+  int64_t text = 0;
+  int64_t blob = 0;
+  // Element counts.
+  int64_t text_array = 0;
+  int64_t int64_array = 0;
+
+  int64_t Total() const {
+    return text + blob + text_array * kArrayElementLength + int64_array * 8;
+  }
+  bool operator==(const RowSizes& other) const {
+    return text == other.text && blob == other.blob &&
+           text_array == other.text_array && int64_array == other.int64_array;
+  }
+};
+
+// Throughput and memory cost of large rows, added to the harness report.
+struct LargeValueStats {
+  int64_t bytes_written = 0;
+  absl::Duration write_time;
+  int64_t bytes_read = 0;
+  absl::Duration read_time;
+  // Growth of the peak RSS over the RSS before the input, summed and maxed
+  // over inputs, per MB written.
+  bool peak_rss_available = true;
+  double peak_rss_bytes = 0;
+  double max_peak_rss_per_mb = 0;
+
+  std::string ToString() const {
+    auto mb = [](double bytes) { return bytes / (1 << 20); };
+    auto rate = [&mb](int64_t bytes, absl::Duration time) {
+      return time > absl::ZeroDuration()
+                 ? mb(bytes) / absl::ToDoubleSeconds(time) : 0.0;
+    };
+    std::string out = absl::StrFormat(
+        "written %.1fMB at %.1fMB/s, read %.1fMB at %.1fMB/s",
+        mb(bytes_written), rate(bytes_written, write_time), mb(bytes_read),
+        rate(bytes_read, read_time));
+    if (!peak_rss_available) {
+      return out + ", peak RSS unavailable";
+    }
+    return out + absl::StrFormat(
+        ", peak RSS %.2fMB per MB written (max %.2fMB)",
+        bytes_written > 0 ? peak_rss_bytes / bytes_written : 0.0,
+        max_peak_rss_per_mb);
+  }
+};
+
+// The database every input writes its row into, and the statistics of the
+// inputs. Rows are deleted again after each input. Rows whose write or delete
+// missed its deadline may still land, so their ids are kept in
+// pending_deletes and deleted again before the next input.
+struct LargeValueTarget {
+  spanner::Client client;
+  LargeValueStats stats;
+  int64_t next_id = 0;
+  std::vector<std::int64_t> pending_deletes;
+};
+
+LargeValueTarget* CreateTarget() {
+  EmulatorHarness* harness = EmulatorHarness::Default();
+  if (harness == nullptr) {
+    return nullptr;
+  }
+  spanner::Database database = harness->NewDatabase();
+  Status status = harness->CreateDatabase(database, {kSchema});
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to create database: " << status.message();
+    return nullptr;
+  }
+  auto* target = new LargeValueTarget{harness->MakeClient(database), {}, 0};
+  harness->AddReportSection("large values",
+                            [target] { return target->stats.ToString(); });
+  return target;
+}
+
+// Mutations deleting the rows with the given ids.
+spanner::Mutations DeleteRowsMutations(const std::vector<std::int64_t>& ids) {
+  spanner::KeySet keys;
+  for (std::int64_t id : ids) keys.AddKey(spanner::MakeKey(id));
+  return {spanner::DeleteMutationBuilder("LargeValues", std::move(keys))
+              .Build()};
+}
+
+// Deletes the rows with the given ids, waiting at most deadline.
+Status DeleteRows(spanner::Client client, const std::vector<std::int64_t>& ids,
+                  absl::Duration deadline) {
+  spanner::Mutations mutations = DeleteRowsMutations(ids);
+  return spanner_emulator_fuzzer::RunWithDeadline(
+      [client, mutations]() mutable {
+        return client.Commit(std::move(mutations)).status();
+      },
+      deadline);
+}
+
+// Reads the row back through a streaming query. Owned by the query, which may
+// outlive RunInput if it misses its deadline.
+struct ReadBack {
+  RowSizes sizes;
+  int rows = 0;
+};
+
+// Writes one row shaped by input with a mutation, reads it back with a
+// streaming query and deletes it, recording each step in profile. Aborts if
+// the row comes back with different sizes than it was written with.
+int RunInput(absl::string_view input, LargeValueTarget* target,
+             InputProfile* profile) {
+  try {
+    RowShape shape(input);
+    if (shape.payload.empty() || shape.columns == 0) {
+      return 0;
+    }
+    int64_t rss_before = spanner_emulator_fuzzer::ReadMemoryUsage().rss_bytes;
+    spanner_emulator_fuzzer::PeakRssSampler peak_rss_sampler;
+    const absl::Duration deadline =
+        spanner_emulator_fuzzer::GetHarnessConfig().rpc_deadline;
+
+    if (!target->pending_deletes.empty()) {
+      InputProfile::ScopedPhase phase(profile, "delete_pending");
+      if (DeleteRows(target->client, target->pending_deletes, deadline).ok()) {
+        target->pending_deletes.clear();
+      }
+    }
+
+    std::int64_t id = target->next_id++;
+    RowSizes written;
+    auto mutations = std::make_shared<spanner::Mutations>();
+    {
+      InputProfile::ScopedPhase phase(profile, "build_row");
+      std::vector<std::string> columns = {"Id"};
+      std::vector<spanner::Value> values = {spanner::Value(id)};
+      std::string text =
+          shape.text() || shape.text_array() ? MakeText(shape) : "";
+      if (shape.text_array()) {
+        std::vector<std::string> text_array = MakeTextArray(text);
+        written.text_array = text_array.size();
+        columns.push_back("TextArray");
+        values.emplace_back(std::move(text_array));
+      }
+      if (shape.text()) {
+        written.text = text.size();
+        columns.push_back("Text");
+        values.emplace_back(std::move(text));
+      }
+      if (shape.blob()) {
+        written.blob = shape.Length(kMaxBytesLength);
+        columns.push_back("Blob");
+        values.emplace_back(MakeBlob(shape));
+      }
+      if (shape.int64_array()) {
+        std::vector<std::int64_t> int64_array = MakeInt64Array(shape);
+        written.int64_array = int64_array.size();
+        columns.push_back("Int64Array");
+        values.emplace_back(std::move(int64_array));
+      }
+      mutations->push_back(
+          spanner::InsertMutationBuilder("LargeValues", std::move(columns))
+              .AddRow(std::move(values))
+              .Build());
+    }
+
+    // Set once the commit missed its deadline. A commit that finishes after
+    // that deletes its own row; one that finished just before is covered by
+    // pending_deletes.
+    auto abandoned = std::make_shared<std::atomic<bool>>(false);
+    Status status;
+    {
+      InputProfile::ScopedPhase phase(profile, "commit");
+      absl::Time start = absl::Now();
+      spanner::Client client = target->client;
+      status = spanner_emulator_fuzzer::RunWithDeadline(
+          [client, mutations, abandoned, id]() mutable {
+            Status commit = client.Commit(std::move(*mutations)).status();
+            if (commit.ok() && abandoned->load()) {
+              client.Commit(DeleteRowsMutations({id}));
+            }
+            return commit;
+          },
+          deadline);
+      target->stats.write_time += absl::Now() - start;
+    }
+    if (!status.ok()) {
+      LOG(INFO) << "Failed to write a " << written.Total()
+                << " byte row: " << status.message();
+      if (status.code() == google::cloud::StatusCode::kDeadlineExceeded) {
+        *abandoned = true;
+        target->pending_deletes.push_back(id);
+      }
+      return 0;
+    }
+    target->stats.bytes_written += written.Total();
+
+    auto read_back = std::make_shared<ReadBack>();
+    {
+      InputProfile::ScopedPhase phase(profile, "read_back");
+      absl::Time start = absl::Now();
+      spanner::Client client = target->client;
+      status = spanner_emulator_fuzzer::RunWithDeadline(
+          [client, id, read_back]() mutable {
+            auto rows = client.ExecuteQuery(spanner::SqlStatement(
+                "SELECT Text, Blob, TextArray, Int64Array FROM LargeValues "
+                "WHERE Id = @id",
+                {{"id", spanner::Value(id)}}));
+            for (auto const& row : rows) {
+              if (!row) return row.status();
+              ++read_back->rows;
+              std::vector<spanner::Value> values = row->values();
+              auto text = values[0].get<std::string>();
+              if (text) read_back->sizes.text = text->size();
+              auto blob = values[1].get<spanner::Bytes>();
+              if (blob) {
+                read_back->sizes.blob =
+                    blob->get<std::string>().size();
+              }
+              auto text_array = values[2].get<std::vector<std::string>>();
+              if (text_array) read_back->sizes.text_array = text_array->size();
+              auto int64_array = values[3].get<std::vector<std::int64_t>>();
+              if (int64_array) {
+                read_back->sizes.int64_array = int64_array->size();
+              }
+            }
+            return Status();
+          },
+          deadline);
+      target->stats.read_time += absl::Now() - start;
+    }
+    if (status.ok()) {
+      target->stats.bytes_read += read_back->sizes.Total();
+      if (read_back->rows != 1 || !(read_back->sizes == written)) {
+        LOG(ERROR) << "Row " << id << " of " << written.Total()
+                   << " bytes came back as " << read_back->rows
+                   << " rows of " << read_back->sizes.Total() << " bytes";
+        std::abort();
+      }
+    }
+
+    {
+      InputProfile::ScopedPhase phase(profile, "delete");
+      if (!DeleteRows(target->client, {id}, deadline).ok()) {
+        target->pending_deletes.push_back(id);
+      }
+    }
+
+    int64_t peak_rss_bytes = peak_rss_sampler.Stop();
+    LargeValueStats& stats = target->stats;
+    stats.peak_rss_available = stats.peak_rss_available && peak_rss_bytes > 0;
+    if (stats.peak_rss_available) {
+      double peak_rss = std::max<int64_t>(0, peak_rss_bytes - rss_before);
+      stats.peak_rss_bytes += peak_rss;
+      stats.max_peak_rss_per_mb =
+          std::max(stats.max_peak_rss_per_mb,
+                   peak_rss / std::max<int64_t>(written.Total(), 1));
+    }
+    return 0;
+  } catch (std::exception const& ex) {
+    LOG(ERROR) << "Standard exception raised: " << ex.what();
+    return 1;
+  }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size) {
+  #ifdef __OSS_FUZZ__
+    static bool Initialized = spanner_emulator_fuzzer::DoOssFuzzInit();
+    if (!Initialized) { std::abort(); }
+  #endif
+
+  static LargeValueTarget* target = CreateTarget();
+  if (target == nullptr) { std::abort(); }
+  static InputRunner runner(EmulatorHarness::Default());
+
+  // A view, not a copy: values are built straight from the fuzzer's buffer.
+  absl::string_view input(reinterpret_cast<const char*>(Data), Size);
+  return runner.Run(input, [&](InputProfile* profile) {
+    return RunInput(input, target, profile);
+  });
+}
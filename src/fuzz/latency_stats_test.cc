@@ -0,0 +1,140 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "src/fuzz/utils/latency_stats.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+using spanner_emulator_fuzzer::LatencyStats;
+
+TEST(LatencyStats, EmptyReportsZero) {
+    LatencyStats stats;
+    EXPECT_EQ(stats.count(), 0);
+    EXPECT_EQ(stats.Mean(), absl::ZeroDuration());
+    EXPECT_EQ(stats.Max(), absl::ZeroDuration());
+    EXPECT_EQ(stats.Percentile(50), absl::ZeroDuration());
+}
+
+TEST(LatencyStats, SmallLatenciesHaveExactBuckets) {
+    LatencyStats stats;
+    for (int nanos = 0; nanos < 8; ++nanos) {
+        stats.Record(absl::Nanoseconds(nanos));
+    }
+    EXPECT_EQ(stats.count(), 8);
+    EXPECT_EQ(stats.Percentile(0), absl::ZeroDuration());
+    EXPECT_EQ(stats.Percentile(50), absl::Nanoseconds(3));
+    EXPECT_EQ(stats.Percentile(100), absl::Nanoseconds(7));
+}
+
+TEST(LatencyStats, BucketsBoundTheError) {
+    for (int64_t nanos : {9, 100, 1000, 123456, 1000000007}) {
+        LatencyStats stats;
+        stats.Record(absl::Nanoseconds(nanos));
+        // A larger maximum, so the bucket's bound is reported rather than
+        // the maximum it is capped at.
+        stats.Record(absl::Seconds(10));
+        absl::Duration bound = stats.Percentile(50);
+        EXPECT_GE(bound, absl::Nanoseconds(nanos)) << nanos;
+        EXPECT_LE(bound, absl::Nanoseconds(nanos + nanos / 8)) << nanos;
+    }
+}
+
+TEST(LatencyStats, Percentiles) {
+    LatencyStats stats;
+    for (int ms = 1; ms <= 100; ++ms) {
+        stats.Record(absl::Milliseconds(ms));
+    }
+    EXPECT_EQ(stats.count(), 100);
+    EXPECT_EQ(stats.Max(), absl::Milliseconds(100));
+    EXPECT_EQ(stats.Mean(), absl::Microseconds(50500));
+    for (int percentile : {1, 50, 90, 99}) {
+        absl::Duration value = stats.Percentile(percentile);
+        EXPECT_GE(value, absl::Milliseconds(percentile)) << percentile;
+        EXPECT_LE(value, absl::Milliseconds(percentile) * 1.125)
+            << percentile;
+    }
+    EXPECT_EQ(stats.Percentile(100), absl::Milliseconds(100));
+}
+
+TEST(LatencyStats, Merge) {
+    LatencyStats fast;
+    LatencyStats slow;
+    for (int i = 0; i < 10; ++i) {
+        fast.Record(absl::Milliseconds(1));
+        slow.Record(absl::Milliseconds(3));
+    }
+    fast.Merge(slow);
+    EXPECT_EQ(fast.count(), 20);
+    EXPECT_EQ(fast.Mean(), absl::Milliseconds(2));
+    EXPECT_EQ(fast.Max(), absl::Milliseconds(3));
+    EXPECT_EQ(fast.Percentile(100), absl::Milliseconds(3));
+    EXPECT_EQ(slow.count(), 10);
+}
+
+TEST(LatencyStats, MergeIntoItself) {
+    LatencyStats stats;
+    stats.Record(absl::Milliseconds(1));
+    stats.Record(absl::Milliseconds(3));
+    stats.Merge(stats);
+    EXPECT_EQ(stats.count(), 4);
+    EXPECT_EQ(stats.Mean(), absl::Milliseconds(2));
+    EXPECT_EQ(stats.Max(), absl::Milliseconds(3));
+}
+
+TEST(LatencyStats, TakeAndClear) {
+    LatencyStats stats;
+    stats.Record(absl::Milliseconds(4));
+    stats.Record(absl::Milliseconds(6));
+
+    LatencyStats taken = stats.TakeAndClear();
+    EXPECT_EQ(taken.count(), 2);
+    EXPECT_EQ(taken.Mean(), absl::Milliseconds(5));
+    EXPECT_EQ(taken.Max(), absl::Milliseconds(6));
+    EXPECT_EQ(stats.count(), 0);
+    EXPECT_EQ(stats.Max(), absl::ZeroDuration());
+
+    stats.Record(absl::Milliseconds(1));
+    EXPECT_EQ(stats.count(), 1);
+    EXPECT_EQ(taken.count(), 2);
+}
+
+TEST(LatencyStats, TakeAndClearLosesNoConcurrentRecord) {
+    constexpr int kThreads = 4;
+    constexpr int kRecordsPerThread = 100000;
+    LatencyStats stats;
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&stats] {
+            for (int j = 0; j < kRecordsPerThread; ++j) {
+                stats.Record(absl::Microseconds(j % 1000));
+            }
+        });
+    }
+    int64_t taken = 0;
+    std::thread reader([&] {
+        while (!done.load()) taken += stats.TakeAndClear().count();
+    });
+    for (std::thread& thread : threads) thread.join();
+    done = true;
+    reader.join();
+    EXPECT_EQ(taken + stats.count(), kThreads * kRecordsPerThread);
+}
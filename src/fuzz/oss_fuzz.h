@@ -26,7 +26,11 @@ const int OVERWRITE = 1;
 
 namespace spanner_emulator_fuzzer {
 
-bool DoOssFuzzInit() {
+inline bool DoOssFuzzInit() {
+#ifdef SPANNER_FUZZ_EMBEDDED_ZONEINFO
+  // Timezone data is compiled into the binary, see utils/embedded_zoneinfo.h
+  return true;
+#else
   namespace fs = std::filesystem;
   fs::path originDir;
   try {
@@ -42,6 +46,7 @@ bool DoOssFuzzInit() {
     return false;
   }
   return true;
+#endif
 }
 
 }  
@@ -0,0 +1,105 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/outcome_features.h"
+
+#include <string>
+
+#include "src/fuzz/utils/harness_config.h"
+#include "gtest/gtest.h"
+
+using spanner_emulator_fuzzer::HarnessConfig;
+using spanner_emulator_fuzzer::NormalizeErrorMessage;
+using spanner_emulator_fuzzer::OutcomeFeatures;
+
+namespace {
+
+// google::cloud::StatusCode values.
+constexpr int kOk = 0;
+constexpr int kInvalidArgument = 3;
+constexpr int kNotFound = 5;
+
+HarnessConfig Enabled() {
+    HarnessConfig config;
+    config.outcome_features = true;
+    return config;
+}
+
+}  // namespace
+
+TEST(NormalizeErrorMessage, DropsIdentifiersQuotesAndNumbers) {
+    EXPECT_EQ(NormalizeErrorMessage(
+                  "Table Foo has a column named \"Bar\" at 1:25"),
+              "has column named at");
+    EXPECT_EQ(NormalizeErrorMessage("Unrecognized name: MyCol"), "name");
+    EXPECT_EQ(NormalizeErrorMessage("value 'it has words' is 12345 long"),
+              "value is long");
+    EXPECT_EQ(NormalizeErrorMessage("`Some Table` not found"), "not found");
+    EXPECT_EQ(NormalizeErrorMessage(""), "");
+}
+
+TEST(NormalizeErrorMessage, SameCategoryForDifferentIdentifiers) {
+    EXPECT_EQ(NormalizeErrorMessage("Table Foo not found at 1:10"),
+              NormalizeErrorMessage("Table BarBaz not found at 22:7"));
+    EXPECT_EQ(NormalizeErrorMessage("Column \"a b\" is 3 bytes"),
+              NormalizeErrorMessage("Column 'c' is 300000 bytes"));
+}
+
+TEST(NormalizeErrorMessage, CapsTheNumberOfWords) {
+    std::string message;
+    for (int i = 0; i < 50; ++i) message += "word ";
+    std::string category = NormalizeErrorMessage(message);
+    EXPECT_EQ(category.size(), 12 * 5 - 1);
+}
+
+TEST(OutcomeFeatures, OkSetsOnlyTheStatusCode) {
+    OutcomeFeatures features(Enabled());
+    features.Record(kOk, "ignored");
+    features.Record(kOk, "also ignored");
+    EXPECT_EQ(features.features_seen(), 1);
+}
+
+TEST(OutcomeFeatures, EqualCategoriesMapToTheSameFeature) {
+    OutcomeFeatures features(Enabled());
+    features.Record(kNotFound, "Table Foo not found at 1:10");
+    EXPECT_EQ(features.features_seen(), 2);
+    features.Record(kNotFound, "Table Bar not found at 2:20");
+    EXPECT_EQ(features.features_seen(), 2);
+}
+
+TEST(OutcomeFeatures, DifferentCategoriesAndCodesAreNewFeatures) {
+    OutcomeFeatures features(Enabled());
+    features.Record(kNotFound, "Table Foo not found");
+    features.Record(kNotFound, "Table Foo already exists");
+    EXPECT_EQ(features.features_seen(), 3);
+    // The same category under another status code is another feature.
+    features.Record(kInvalidArgument, "Table Foo not found");
+    EXPECT_EQ(features.features_seen(), 5);
+}
+
+TEST(OutcomeFeatures, DisabledOrOutOfRangeRecordsNothing) {
+    HarnessConfig config;
+    config.outcome_features = false;
+    OutcomeFeatures disabled(config);
+    disabled.Record(kNotFound, "Table Foo not found");
+    EXPECT_EQ(disabled.features_seen(), 0);
+    EXPECT_EQ(disabled.StatsString(), "disabled");
+
+    OutcomeFeatures features(Enabled());
+    features.Record(-1, "negative");
+    features.Record(OutcomeFeatures::kNumStatusCodes, "too large");
+    EXPECT_EQ(features.features_seen(), 0);
+}
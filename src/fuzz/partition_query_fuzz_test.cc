@@ -0,0 +1,263 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "libprotobuf_mutator/src/libfuzzer/libfuzzer_macro.h"
+
+#include "src/fuzz/protobufs/create_table.pb.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_proto_to_string.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_validator.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_value_generator.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "src/fuzz/oss_fuzz.h"
+#include "src/fuzz/utils/deadline.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/fuzz_target.h"
+#include "src/fuzz/utils/harness_config.h"
+#include "src/fuzz/utils/input_profile.h"
+#include "src/fuzz/utils/latency_stats.h"
+#include "src/fuzz/utils/outcome_features.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "zetasql/base/logging.h"
+#include "google/cloud/spanner/client.h"
+
+namespace spanner = ::google::cloud::spanner;
+using ::google::cloud::Status;
+using spanner_ddl::CreateTable;
+using ::spanner_emulator_fuzzer::DDLValidity;
+using ::spanner_emulator_fuzzer::EmulatorHarness;
+using ::spanner_emulator_fuzzer::InputProfile;
+using ::spanner_emulator_fuzzer::InputRunner;
+using ::spanner_emulator_fuzzer::LatencyStats;
+using ::spanner_emulator_fuzzer::OutcomeFeatures;
+using ::spanner_emulator_fuzzer::ValueGenerator;
+
+// Rows inserted before the scans, one commit each so that a duplicate key
+// only loses its own row.
+constexpr int kRows = 8;
+// The input picks max_partitions in [1, kMaxPartitions]. Partitions are
+// executed by kPartitionThreads threads, each taking every
+// kPartitionThreads-th partition.
+constexpr int kMaxPartitions = 8;
+constexpr int kPartitionThreads = 4;
+
+// Scan latencies, and how many partitions PartitionQuery returned for each
+// max_partitions. Printed as the "partition query" report section.
+struct PartitionQueryStats {
+  LatencyStats full_scans;
+  LatencyStats partitioned_scans;
+  std::array<std::atomic<int64_t>, kMaxPartitions + 1> requested{};
+  std::array<std::atomic<int64_t>, kMaxPartitions + 1> returned{};
+
+  std::string StatsString() const {
+    std::string out = absl::StrCat(
+        "full scans: ", full_scans.Summary(), "\n",
+        "partitioned scans: ", partitioned_scans.Summary(), "\n");
+    absl::StrAppendFormat(&out, "%15s %10s %16s\n", "max_partitions",
+                          "queries", "mean partitions");
+    for (int max = 1; max <= kMaxPartitions; ++max) {
+      int64_t queries = requested[max].load();
+      if (queries == 0) continue;
+      absl::StrAppendFormat(&out, "%15d %10d %16.2f\n", max, queries,
+                            static_cast<double>(returned[max].load()) / queries);
+    }
+    return out;
+  }
+};
+
+// Rows as rendered by RowToString, from both ways of scanning the table.
+struct ScanResult {
+  std::vector<std::string> full_scan;
+  std::vector<std::string> partitioned_scan;
+  size_t partitions = 0;
+  absl::Duration full_scan_time;
+  absl::Duration partitioned_scan_time;
+};
+
+PartitionQueryStats* CreatePartitionQueryStats(EmulatorHarness* harness) {
+  auto* stats = new PartitionQueryStats;
+  harness->AddReportSection("partition query",
+                            [stats] { return stats->StatsString(); });
+  return stats;
+}
+
+std::string RowToString(const spanner::Row& row) {
+  std::ostringstream out;
+  for (const spanner::Value& value : row.values()) out << value << ",";
+  return out.str();
+}
+
+// Appends every row of rows to out, returning the first error.
+Status Drain(spanner::RowStream rows, std::vector<std::string>* out) {
+  for (auto const& row : rows) {
+    if (!row) return row.status();
+    out->push_back(RowToString(*row));
+  }
+  return Status();
+}
+
+// Scans the whole table once with a plain query and once through
+// PartitionQuery, in the same read-only transaction so both see the same
+// data. Partitions run concurrently on kPartitionThreads threads.
+Status Scan(spanner::Client client, const std::string& query,
+            int max_partitions, ScanResult* result) {
+  spanner::Transaction txn = spanner::MakeReadOnlyTransaction();
+  absl::Time start = absl::Now();
+  Status status = Drain(client.ExecuteQuery(txn, spanner::SqlStatement(query)),
+                        &result->full_scan);
+  if (!status.ok()) return status;
+  result->full_scan_time = absl::Now() - start;
+
+  start = absl::Now();
+  spanner::PartitionOptions options;
+  options.max_partitions = max_partitions;
+  auto partitions =
+      client.PartitionQuery(txn, spanner::SqlStatement(query), options);
+  if (!partitions) return partitions.status();
+  result->partitions = partitions->size();
+
+  std::vector<std::vector<std::string>> rows(kPartitionThreads);
+  std::vector<Status> statuses(kPartitionThreads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kPartitionThreads; ++i) {
+    threads.emplace_back([&, i] {
+      for (size_t p = i; p < partitions->size(); p += kPartitionThreads) {
+        statuses[i] = Drain(client.ExecuteQuery((*partitions)[p]), &rows[i]);
+        if (!statuses[i].ok()) return;
+      }
+    });
+  }
+  for (std::thread& thread : threads) thread.join();
+  for (int i = 0; i < kPartitionThreads; ++i) {
+    if (!statuses[i].ok()) return statuses[i];
+    result->partitioned_scan.insert(result->partitioned_scan.end(),
+                                    rows[i].begin(), rows[i].end());
+  }
+  result->partitioned_scan_time = absl::Now() - start;
+  return Status();
+}
+
+// Creates the input's table, inserts generated rows and checks that the
+// union of the rows returned by the partitions of "SELECT * FROM <table>"
+// equals a single full scan. A difference aborts the process so the input
+// is saved as a crash.
+int RunInput(const CreateTable& createTable, EmulatorHarness& harness,
+             PartitionQueryStats* stats, OutcomeFeatures* features,
+             InputProfile* profile) {
+  try {
+    if (spanner_emulator_fuzzer::validate(createTable) != DDLValidity::kValid) {
+      return 0;
+    }
+    std::string createTableDDLStatement = toString(createTable);
+
+    spanner::Database database = harness.NewDatabase();
+    Status status;
+    {
+      InputProfile::ScopedPhase phase(profile, "create_database");
+      status = harness.CreateDatabase(database, {createTableDDLStatement});
+    }
+    if (!status.ok()) {
+      spanner_emulator_fuzzer::RecordOutcome(features, status);
+      return 0;
+    }
+
+    spanner::Client client = harness.MakeClient(database);
+    uint64_t seed = std::hash<std::string>()(createTableDDLStatement);
+    ValueGenerator generator(seed, spanner_emulator_fuzzer::kMaxValueLength);
+    {
+      InputProfile::ScopedPhase phase(profile, "inserts");
+      for (int i = 0; i < kRows; ++i) {
+        std::string insert =
+            spanner_emulator_fuzzer::insertStatement(createTable, 1, &generator);
+        status = spanner_emulator_fuzzer::CommitDml(
+            client, std::move(insert),
+            spanner_emulator_fuzzer::GetHarnessConfig().rpc_deadline);
+        spanner_emulator_fuzzer::RecordOutcome(features, status);
+      }
+    }
+
+    int max_partitions = 1 + seed % kMaxPartitions;
+    std::string query = absl::StrCat("SELECT * FROM ", createTable.tablename());
+    auto result = std::make_shared<ScanResult>();
+    {
+      InputProfile::ScopedPhase phase(profile, "scans");
+      status = spanner_emulator_fuzzer::RunWithDeadline(
+          [client, query, max_partitions, result] {
+            return Scan(client, query, max_partitions, result.get());
+          },
+          spanner_emulator_fuzzer::GetHarnessConfig().rpc_deadline);
+    }
+    spanner_emulator_fuzzer::RecordOutcome(features, status);
+    if (status.ok()) {
+      stats->full_scans.Record(result->full_scan_time);
+      stats->partitioned_scans.Record(result->partitioned_scan_time);
+      ++stats->requested[max_partitions];
+      stats->returned[max_partitions] += result->partitions;
+
+      std::sort(result->full_scan.begin(), result->full_scan.end());
+      std::sort(result->partitioned_scan.begin(),
+                result->partitioned_scan.end());
+      if (result->full_scan != result->partitioned_scan) {
+        LOG(ERROR) << "A full scan returned " << result->full_scan.size()
+                   << " rows, but the union of " << result->partitions
+                   << " partitions returned " << result->partitioned_scan.size()
+                   << " rows that differ";
+        std::abort();
+      }
+    }
+
+    InputProfile::ScopedPhase phase(profile, "drop_database");
+    harness.DropDatabase(database);
+    return 0;
+  } catch (std::exception const& ex) {
+    LOG(ERROR) << "Standard exception raised: " << ex.what();
+    return 1;
+  }
+}
+
+DEFINE_PROTO_FUZZER(const CreateTable& createTable) {
+  #ifdef __OSS_FUZZ__
+    static bool Initialized = spanner_emulator_fuzzer::DoOssFuzzInit();
+    if (!Initialized) { std::abort(); }
+  #endif
+
+  static EmulatorHarness* harness = EmulatorHarness::Default();
+  if (harness == nullptr) { std::abort(); }
+  static PartitionQueryStats* partition_query_stats =
+      CreatePartitionQueryStats(harness);
+  static OutcomeFeatures* outcome_features =
+      spanner_emulator_fuzzer::CreateOutcomeFeatures(harness);
+  static InputRunner runner(harness);
+
+  runner.Run(createTable, [&](InputProfile* profile) {
+    return RunInput(createTable, *harness, partition_query_stats,
+                    outcome_features, profile);
+  });
+}
@@ -0,0 +1,155 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_feature_stats.h"
+
+#include "src/fuzz/protobufs/create_table.pb.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "absl/strings/str_format.h"
+
+namespace spanner_emulator_fuzzer {
+
+namespace {
+
+using spanner_ddl::Column;
+using spanner_ddl::ColumnDataType;
+
+void increment(std::atomic<int64_t>* counter) {
+    counter->fetch_add(1, std::memory_order_relaxed);
+}
+
+int64_t load(const std::atomic<int64_t>& counter) {
+    return counter.load(std::memory_order_relaxed);
+}
+
+int countBucket(int count) {
+    return std::min(count, DDLFeatureStats::kMaxCount);
+}
+
+int lengthBucket(int64_t length) {
+    int bucket = 0;
+    while (length > 0 && bucket < DDLFeatureStats::kNumLengthBuckets - 1) {
+        length >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+std::string lengthBucketName(int bucket) {
+    if (bucket == 0) {
+        return "<1";
+    }
+    return absl::StrFormat("[%d,%d)", int64_t{1} << (bucket - 1),
+        int64_t{1} << bucket);
+}
+
+void appendCounts(const char* name, const std::atomic<int64_t>* counts,
+    std::string* out) {
+    absl::StrAppendFormat(out, "%s:", name);
+    for (int i = 0; i <= DDLFeatureStats::kMaxCount; ++i) {
+        if (load(counts[i]) != 0) {
+            absl::StrAppendFormat(out, " %d%s=%d", i,
+                i == DDLFeatureStats::kMaxCount ? "+" : "", load(counts[i]));
+        }
+    }
+    out->append("\n");
+}
+
+}  // namespace
+
+void DDLFeatureStats::recordTable(int primary_keys, int non_primary_keys) {
+    increment(&tables_);
+    increment(&primary_keys_[countBucket(primary_keys)]);
+    increment(&columns_[countBucket(primary_keys + non_primary_keys)]);
+}
+
+void DDLFeatureStats::recordColumn(const Column& column) {
+    int type = column.columndatatype().scalartype();
+    increment(column.columndatatype().isarray() ? &array_columns_[type]
+                                                : &scalar_columns_[type]);
+    if (column.isnotnull()) {
+        increment(&not_null_columns_[type]);
+    }
+    if (column.allowcommittimestamp()) {
+        increment(&commit_timestamp_columns_[type]);
+    }
+}
+
+void DDLFeatureStats::recordLength(ColumnDataType::LengthType length_type,
+    int64_t length) {
+    increment(&length_types_[length_type]);
+    if (length_type != ColumnDataType::MAX) {
+        increment(&lengths_[length_type][lengthBucket(length)]);
+    }
+}
+
+void DDLFeatureStats::clear() {
+    tables_ = 0;
+    for (auto& counter : primary_keys_) counter = 0;
+    for (auto& counter : columns_) counter = 0;
+    for (int i = 0; i < kNumScalarTypes; ++i) {
+        scalar_columns_[i] = 0;
+        array_columns_[i] = 0;
+        not_null_columns_[i] = 0;
+        commit_timestamp_columns_[i] = 0;
+    }
+    for (int i = 0; i < kNumLengthTypes; ++i) {
+        length_types_[i] = 0;
+        for (auto& counter : lengths_[i]) counter = 0;
+    }
+}
+
+std::string DDLFeatureStats::StatsString() const {
+    std::string out = absl::StrFormat("tables: %d\n", load(tables_));
+    appendCounts("primary keys", primary_keys_, &out);
+    appendCounts("columns", columns_, &out);
+
+    absl::StrAppendFormat(&out, "%-10s %10s %10s %10s %10s\n", "type",
+        "scalar", "array", "not_null", "commit_ts");
+    for (int i = 0; i < kNumScalarTypes; ++i) {
+        absl::StrAppendFormat(&out, "%-10s %10d %10d %10d %10d\n",
+            ColumnDataType::ScalarType_Name(
+                static_cast<ColumnDataType::ScalarType>(i)),
+            load(scalar_columns_[i]), load(array_columns_[i]),
+            load(not_null_columns_[i]), load(commit_timestamp_columns_[i]));
+    }
+
+    for (int i = 0; i < kNumLengthTypes; ++i) {
+        absl::StrAppendFormat(&out, "length %s: %d",
+            ColumnDataType::LengthType_Name(
+                static_cast<ColumnDataType::LengthType>(i)),
+            load(length_types_[i]));
+        for (int bucket = 0; bucket < kNumLengthBuckets; ++bucket) {
+            if (load(lengths_[i][bucket]) != 0) {
+                absl::StrAppendFormat(&out, " %s=%d", lengthBucketName(bucket),
+                    load(lengths_[i][bucket]));
+            }
+        }
+        out.append("\n");
+    }
+    return out;
+}
+
+DDLFeatureStats& ddlFeatureStats() {
+    static DDLFeatureStats* stats = new DDLFeatureStats;
+    return *stats;
+}
+
+}  // namespace spanner_emulator_fuzzer
@@ -0,0 +1,74 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef SRC_FUZZ_PROTOBUF_UTILS_SPANNER_EMULATOR_DDL_STATEMENT_FEATURE_STATS_H
+#define SRC_FUZZ_PROTOBUF_UTILS_SPANNER_EMULATOR_DDL_STATEMENT_FEATURE_STATS_H
+
+#include "src/fuzz/protobufs/create_table.pb.h"
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace spanner_emulator_fuzzer {
+
+// Histograms of the features of the statements toString renders, recorded by
+// recordFeatures, to see which parts of the DDL space the mutator actually
+// explores. Lengths are recorded as rendered, after BOUND lengths are
+// squashed into range.
+// Counters are relaxed atomics, so recording costs a few increments per
+// column.
+class DDLFeatureStats {
+ public:
+    static constexpr int kNumScalarTypes =
+        spanner_ddl::ColumnDataType::ScalarType_ARRAYSIZE;
+    static constexpr int kNumLengthTypes =
+        spanner_ddl::ColumnDataType::LengthType_ARRAYSIZE;
+    // Lengths below 1, then one bucket per power of two.
+    static constexpr int kNumLengthBuckets = 33;
+    // Key and column counts above this share the last bucket.
+    static constexpr int kMaxCount = 16;
+
+    void recordTable(int primary_keys, int non_primary_keys);
+    void recordColumn(const spanner_ddl::Column& column);
+    // Called for STRING and BYTES columns. length is ignored for MAX.
+    void recordLength(spanner_ddl::ColumnDataType::LengthType length_type,
+        int64_t length);
+
+    void clear();
+
+    // Tables of the non-zero counters.
+    std::string StatsString() const;
+
+ private:
+    std::atomic<int64_t> tables_{0};
+    std::atomic<int64_t> primary_keys_[kMaxCount + 1] = {};
+    std::atomic<int64_t> columns_[kMaxCount + 1] = {};
+    // Indexed by scalar type.
+    std::atomic<int64_t> scalar_columns_[kNumScalarTypes] = {};
+    std::atomic<int64_t> array_columns_[kNumScalarTypes] = {};
+    std::atomic<int64_t> not_null_columns_[kNumScalarTypes] = {};
+    std::atomic<int64_t> commit_timestamp_columns_[kNumScalarTypes] = {};
+    // Indexed by length type.
+    std::atomic<int64_t> length_types_[kNumLengthTypes] = {};
+    std::atomic<int64_t> lengths_[kNumLengthTypes][kNumLengthBuckets] = {};
+};
+
+// The process-wide stats recordFeatures records to.
+DDLFeatureStats& ddlFeatureStats();
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif // SRC_FUZZ_PROTOBUF_UTILS_SPANNER_EMULATOR_DDL_STATEMENT_FEATURE_STATS_H
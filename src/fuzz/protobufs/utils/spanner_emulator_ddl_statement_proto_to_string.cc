@@ -14,8 +14,10 @@
 // limitations under the License.
 //
 
+#include "src/fuzz/protobufs/alter_table.pb.h"
 #include "src/fuzz/protobufs/create_table.pb.h"
 #include "src/fuzz/protobufs/spanner_ddl.pb.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_feature_stats.h"
 
 #include <google/protobuf/repeated_field.h>
 
@@ -28,13 +30,21 @@
 
 using spanner_ddl::SpannerDDLStatement;
 using spanner_ddl::CreateTable;
+using spanner_ddl::AlterTable;
+using spanner_ddl::AlterColumn;
+using spanner_ddl::SetColumnOptions;
 using spanner_ddl::Column;
 using spanner_ddl::ColumnDataType;
 using google::protobuf::RepeatedPtrField;
+using spanner_emulator_fuzzer::DDLFeatureStats;
+using spanner_emulator_fuzzer::ddlFeatureStats;
 
 // forward declarations
 std::string toString(const SpannerDDLStatement& statement);
 std::string toString(const CreateTable& create_table);
+std::string toString(const AlterTable& alter_table);
+std::string toString(const AlterColumn& alter_column);
+std::string toString(const SetColumnOptions& set_column_options);
 std::string tableColumnsToString(const RepeatedPtrField<Column>& primary_keys,
     const RepeatedPtrField<Column>& non_primary_keys);
 std::string toString(const RepeatedPtrField<Column>& columns);
@@ -47,6 +57,12 @@ std::string columnOptionsToString(bool allow_commit_timestamps);
 std::string toPrimaryKeys(const RepeatedPtrField<Column>& columns);
 std::string columnToPrimaryKey(const Column& column);
 std::string toString(const Column::Orientation& orientation);
+void recordFeatures(const CreateTable& create_table);
+
+// BOUND lengths are squashed into [0, max_length) so any input renders.
+int boundLength(int length, int max_length) {
+    return (std::abs(length) + 1) % max_length;
+}
 
 // Transforms any Emulator DDL statement into a syntactically valid string
 std::string toString(const SpannerDDLStatement& statement) {
@@ -54,6 +70,8 @@ std::string toString(const SpannerDDLStatement& statement) {
     switch (statement.DDLStatement_case()) {
         case statementType::kCreateTable:
             return toString(statement.createtable());
+        case statementType::kAlterTable:
+            return toString(statement.altertable());
         //TODO: add more cases here for additional APIs
         default:
             return "";
@@ -69,6 +87,48 @@ std::string toString(const CreateTable& create_table) {
                 toPrimaryKeys(create_table.primarykeys()));
 }
 
+// generates an 'ALTER TABLE ...' statement, or an empty string if the
+// alteration is missing
+std::string toString(const AlterTable& alter_table) {
+    using alterationType = AlterTable::TableAlterationCase;
+    std::string alteration;
+    switch (alter_table.TableAlteration_case()) {
+        case alterationType::kAddColumn:
+            alteration = absl::StrCat("ADD COLUMN ",
+                toString(alter_table.addcolumn()));
+            break;
+        case alterationType::kDropColumn:
+            alteration = absl::StrCat("DROP COLUMN ",
+                alter_table.dropcolumn());
+            break;
+        case alterationType::kAlterColumn:
+            alteration = toString(alter_table.altercolumn());
+            break;
+        case alterationType::kSetColumnOptions:
+            alteration = toString(alter_table.setcolumnoptions());
+            break;
+        default:
+            return "";
+    }
+    return absl::Substitute("ALTER TABLE $0 $1", alter_table.tablename(),
+        alteration);
+}
+
+// ALTER COLUMN column_name data_type [ NOT NULL ]
+std::string toString(const AlterColumn& alter_column) {
+    return absl::Substitute("ALTER COLUMN $0 $1 $2",
+        alter_column.columnname(),
+        toString(alter_column.columndatatype()),
+        isColumnNotNullToString(alter_column.isnotnull()));
+}
+
+// ALTER COLUMN column_name SET OPTIONS ( allow_commit_timestamp = ... )
+std::string toString(const SetColumnOptions& set_column_options) {
+    return absl::Substitute("ALTER COLUMN $0 SET $1",
+        set_column_options.columnname(),
+        columnOptionsToString(set_column_options.allowcommittimestamp()));
+}
+
 // returns a string representing all columns of the table depending on
 // which exist
 std::string tableColumnsToString(const RepeatedPtrField<Column>& primary_keys,
@@ -132,10 +192,8 @@ std::string toString(const ColumnDataType::ScalarType& scalar_type, int length,
         case ColumnDataType::STRING:
             switch (length_type) {
                 case ColumnDataType::BOUND:
-                    // ensures length is a positive number
-                    length = std::abs(length) + 1;
                     return absl::Substitute("STRING( $0 )", 
-                        std::to_string(length % 2621440));
+                        std::to_string(boundLength(length, 2621440)));
                 case ColumnDataType::UNBOUND:
                     return absl::Substitute("STRING( $0 )", 
                         std::to_string(length));
@@ -147,10 +205,8 @@ std::string toString(const ColumnDataType::ScalarType& scalar_type, int length,
         case ColumnDataType::BYTES:
             switch (length_type) {
                 case ColumnDataType::BOUND:
-                    // ensures length is a positive number
-                    length = std::abs(length) + 1;
                     return absl::Substitute("BYTES( $0 )", 
-                        std::to_string(length % 10485760));
+                        std::to_string(boundLength(length, 10485760)));
                 case ColumnDataType::UNBOUND:
                     return absl::Substitute("BYTES( $0 )", 
                         std::to_string(length));
@@ -206,3 +262,34 @@ std::string toString(const Column::Orientation& orientation) {
     }
 }
 
+
+// Records the features of the statement toString(create_table) renders,
+// with lengths as rendered. Fuzz targets call this once per input, so that
+// rendering a statement again, e.g. for a report, does not count it twice.
+void recordFeatures(const CreateTable& create_table) {
+    DDLFeatureStats& stats = ddlFeatureStats();
+    stats.recordTable(create_table.primarykeys_size(),
+        create_table.nonprimarykeys_size());
+    for (const auto* columns :
+            {&create_table.primarykeys(), &create_table.nonprimarykeys()}) {
+        for (const Column& column : *columns) {
+            stats.recordColumn(column);
+            const ColumnDataType& data_type = column.columndatatype();
+            int max_length;
+            switch (data_type.scalartype()) {
+                case ColumnDataType::STRING:
+                    max_length = 2621440;
+                    break;
+                case ColumnDataType::BYTES:
+                    max_length = 10485760;
+                    break;
+                default:
+                    continue;
+            }
+            stats.recordLength(data_type.lengthtype(),
+                data_type.lengthtype() == ColumnDataType::BOUND
+                    ? boundLength(data_type.length(), max_length)
+                    : data_type.length());
+        }
+    }
+}
@@ -16,6 +16,7 @@
 #ifndef SRC_FUZZ_PROTOBUF_UTILS_SPANNER_EMULATOR_DDL_STATEMENT_PROTO_TO_STRING_H
 #define SRC_FUZZ_PROTOBUF_UTILS_SPANNER_EMULATOR_DDL_STATEMENT_PROTO_TO_STRING_H
 
+#include "src/fuzz/protobufs/alter_table.pb.h"
 #include "src/fuzz/protobufs/create_table.pb.h"
 #include "src/fuzz/protobufs/spanner_ddl.pb.h"
 
@@ -27,6 +28,9 @@
 
 using spanner_ddl::SpannerDDLStatement;
 using spanner_ddl::CreateTable;
+using spanner_ddl::AlterTable;
+using spanner_ddl::AlterColumn;
+using spanner_ddl::SetColumnOptions;
 using spanner_ddl::Column;
 using spanner_ddl::ColumnDataType;
 using google::protobuf::RepeatedPtrField;
@@ -34,6 +38,9 @@ using google::protobuf::RepeatedPtrField;
 // proto to string methods
 std::string toString(const SpannerDDLStatement& statement);
 std::string toString(const CreateTable& create_table);
+std::string toString(const AlterTable& alter_table);
+std::string toString(const AlterColumn& alter_column);
+std::string toString(const SetColumnOptions& set_column_options);
 std::string tableColumnsToString(const RepeatedPtrField<Column>& primary_keys,
     const RepeatedPtrField<Column>& non_primary_keys);
 std::string toString(const RepeatedPtrField<Column>& columns);
@@ -47,4 +54,8 @@ std::string toPrimaryKeys(const RepeatedPtrField<Column>& columns);
 std::string columnToPrimaryKey(const Column& column);
 std::string toString(const Column::Orientation& orientation);
 
+// Records the features of toString(create_table) in ddlFeatureStats().
+// toString itself has no side effects.
+void recordFeatures(const CreateTable& create_table);
+
 #endif // SRC_FUZZ_PROTOBUF_UTILS_SPANNER_EMULATOR_DDL_STATEMENT_PROTO_TO_STRING_H
\ No newline at end of file
@@ -0,0 +1,168 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_validator.h"
+
+#include "src/fuzz/protobufs/create_table.pb.h"
+
+#include <google/protobuf/repeated_field.h>
+
+#include <cstdint>
+#include <string>
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+
+namespace spanner_emulator_fuzzer {
+
+namespace {
+
+using spanner_ddl::Column;
+using spanner_ddl::ColumnDataType;
+using spanner_ddl::CreateTable;
+using google::protobuf::RepeatedPtrField;
+
+// Spanner's limits, matching the ones toString applies to BOUND lengths.
+constexpr int kMaxIdentifierLength = 128;
+constexpr int64_t kMaxStringLength = 2621440;
+constexpr int64_t kMaxBytesLength = 10485760;
+
+bool isValidIdentifier(absl::string_view name) {
+    if (name.empty() || name.size() > kMaxIdentifierLength ||
+        absl::ascii_isdigit(name[0])) {
+        return false;
+    }
+    for (char c : name) {
+        if (!absl::ascii_isalnum(c) && c != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool hasValidLength(const ColumnDataType& data_type) {
+    if (data_type.lengthtype() != ColumnDataType::UNBOUND) {
+        return true;
+    }
+    switch (data_type.scalartype()) {
+        case ColumnDataType::STRING:
+            return data_type.length() >= 1 &&
+                data_type.length() <= kMaxStringLength;
+        case ColumnDataType::BYTES:
+            return data_type.length() >= 1 &&
+                data_type.length() <= kMaxBytesLength;
+        default:
+            // Other types render without a length.
+            return true;
+    }
+}
+
+// Checks the type and options of a single column definition.
+DDLValidity validateColumn(const Column& column) {
+    if (!hasValidLength(column.columndatatype())) {
+        return DDLValidity::kInvalidLength;
+    }
+    if (column.allowcommittimestamp() &&
+        !column.columndatatype().isarray() &&
+        column.columndatatype().scalartype() != ColumnDataType::TIMESTAMP) {
+        return DDLValidity::kCommitTimestampOnNonTimestamp;
+    }
+    return DDLValidity::kValid;
+}
+
+}  // namespace
+
+const char* validityName(DDLValidity validity) {
+    switch (validity) {
+        case DDLValidity::kValid:
+            return "valid";
+        case DDLValidity::kInvalidIdentifier:
+            return "invalid_identifier";
+        case DDLValidity::kDuplicateColumnName:
+            return "duplicate_column_name";
+        case DDLValidity::kArrayPrimaryKey:
+            return "array_primary_key";
+        case DDLValidity::kInvalidLength:
+            return "invalid_length";
+        case DDLValidity::kCommitTimestampOnNonTimestamp:
+            return "commit_timestamp_on_non_timestamp";
+        default:
+            return "unknown";
+    }
+}
+
+DDLValidity validate(const CreateTable& create_table) {
+    if (!isValidIdentifier(create_table.tablename())) {
+        return DDLValidity::kInvalidIdentifier;
+    }
+    for (const auto* columns :
+            {&create_table.primarykeys(), &create_table.nonprimarykeys()}) {
+        for (const Column& column : *columns) {
+            if (!isValidIdentifier(column.columnname())) {
+                return DDLValidity::kInvalidIdentifier;
+            }
+        }
+    }
+
+    // Identifiers are case-insensitive. Key columns are rendered both as
+    // column definitions and key parts, so a repeated key is a duplicate too.
+    absl::flat_hash_set<std::string> names;
+    for (const auto* columns :
+            {&create_table.primarykeys(), &create_table.nonprimarykeys()}) {
+        for (const Column& column : *columns) {
+            if (!names.insert(absl::AsciiStrToLower(column.columnname()))
+                    .second) {
+                return DDLValidity::kDuplicateColumnName;
+            }
+        }
+    }
+
+    for (const Column& column : create_table.primarykeys()) {
+        if (column.columndatatype().isarray()) {
+            return DDLValidity::kArrayPrimaryKey;
+        }
+    }
+
+    for (const auto* columns :
+            {&create_table.primarykeys(), &create_table.nonprimarykeys()}) {
+        for (const Column& column : *columns) {
+            DDLValidity validity = validateColumn(column);
+            if (validity != DDLValidity::kValid) {
+                return validity;
+            }
+        }
+    }
+    return DDLValidity::kValid;
+}
+
+std::string DDLValidationStats::StatsString() const {
+    int64_t total = 0;
+    for (int64_t count : counts_) {
+        total += count;
+    }
+    std::string out;
+    for (int i = 0; i < static_cast<int>(DDLValidity::kNumValidities); ++i) {
+        absl::StrAppendFormat(&out, "%-34s %10d %6.2f%%\n",
+            validityName(static_cast<DDLValidity>(i)), counts_[i],
+            total == 0 ? 0.0 : 100.0 * counts_[i] / total);
+    }
+    absl::StrAppendFormat(&out, "%-34s %10d", "invalid_accepted_by_emulator",
+        mispredictions_);
+    return out;
+}
+
+}  // namespace spanner_emulator_fuzzer
@@ -0,0 +1,74 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef SRC_FUZZ_PROTOBUF_UTILS_SPANNER_EMULATOR_DDL_STATEMENT_VALIDATOR_H
+#define SRC_FUZZ_PROTOBUF_UTILS_SPANNER_EMULATOR_DDL_STATEMENT_VALIDATOR_H
+
+#include "src/fuzz/protobufs/create_table.pb.h"
+
+#include <cstdint>
+#include <string>
+
+namespace spanner_emulator_fuzzer {
+
+// Why a rendered statement is known to be rejected by the emulator. Only
+// reasons that are certain are detected, anything else is kValid and left
+// to the emulator to judge.
+enum class DDLValidity {
+    kValid = 0,
+    // Empty, too long or containing characters outside [A-Za-z0-9_]. Reserved
+    // keywords are not checked.
+    kInvalidIdentifier,
+    // Two columns whose names only differ in case, or a repeated key column.
+    kDuplicateColumnName,
+    kArrayPrimaryKey,
+    // An UNBOUND STRING or BYTES length outside [1, max], rendered verbatim.
+    kInvalidLength,
+    // allow_commit_timestamp = true on a scalar column other than TIMESTAMP.
+    kCommitTimestampOnNonTimestamp,
+    kNumValidities,
+};
+
+const char* validityName(DDLValidity validity);
+
+// Classifies the statement toString(create_table) renders to, returning the
+// first reason found.
+DDLValidity validate(const spanner_ddl::CreateTable& create_table);
+
+// Counts how inputs were classified, for the harness statistics report.
+class DDLValidationStats {
+ public:
+    void record(DDLValidity validity) {
+        ++counts_[static_cast<int>(validity)];
+    }
+    int64_t count(DDLValidity validity) const {
+        return counts_[static_cast<int>(validity)];
+    }
+
+    // An input predicted invalid was accepted by the emulator.
+    void recordMisprediction() { ++mispredictions_; }
+    int64_t mispredictions() const { return mispredictions_; }
+
+    // One line per classification with its count and share of all inputs.
+    std::string StatsString() const;
+
+ private:
+    int64_t counts_[static_cast<int>(DDLValidity::kNumValidities)] = {};
+    int64_t mispredictions_ = 0;
+};
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif // SRC_FUZZ_PROTOBUF_UTILS_SPANNER_EMULATOR_DDL_STATEMENT_VALIDATOR_H
@@ -0,0 +1,131 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/protobufs/utils/spanner_emulator_value_generator.h"
+
+#include "src/fuzz/protobufs/create_table.pb.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+
+namespace spanner_emulator_fuzzer {
+
+namespace {
+
+using spanner_ddl::Column;
+using spanner_ddl::ColumnDataType;
+using spanner_ddl::CreateTable;
+
+constexpr char kAlphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789";
+constexpr int kMaxArrayElements = 3;
+
+}  // namespace
+
+bool isCommitTimestampColumn(const Column& column) {
+    return column.allowcommittimestamp() &&
+        !column.columndatatype().isarray() &&
+        column.columndatatype().scalartype() == ColumnDataType::TIMESTAMP;
+}
+
+std::string ValueGenerator::literal(const Column& column) {
+    if (isCommitTimestampColumn(column)) {
+        return "PENDING_COMMIT_TIMESTAMP()";
+    }
+    if (!column.isnotnull() && rng_() % 8 == 0) {
+        return "NULL";
+    }
+    return literal(column.columndatatype());
+}
+
+std::string ValueGenerator::literal(const ColumnDataType& data_type) {
+    if (!data_type.isarray()) {
+        return scalarLiteral(data_type.scalartype());
+    }
+    std::vector<std::string> elements(rng_() % (kMaxArrayElements + 1));
+    for (std::string& element : elements) {
+        element = scalarLiteral(data_type.scalartype());
+    }
+    return absl::StrCat("[", absl::StrJoin(elements, ", "), "]");
+}
+
+std::string ValueGenerator::scalarLiteral(ColumnDataType::ScalarType type) {
+    switch (type) {
+        case ColumnDataType::BOOL:
+            return rng_() % 2 == 0 ? "TRUE" : "FALSE";
+        case ColumnDataType::INT64:
+            return std::to_string(static_cast<int64_t>(rng_() >> 1) -
+                (int64_t{1} << 62));
+        case ColumnDataType::FLOAT64:
+            return absl::StrFormat("CAST(%.17g AS FLOAT64)",
+                std::uniform_real_distribution<double>(-1e9, 1e9)(rng_));
+        case ColumnDataType::STRING:
+            return absl::StrCat("'", characters(), "'");
+        case ColumnDataType::BYTES:
+            return absl::StrCat("b'", characters(), "'");
+        case ColumnDataType::DATE:
+            return absl::StrFormat("DATE '%04d-%02d-%02d'",
+                1 + rng_() % 9999, 1 + rng_() % 12, 1 + rng_() % 28);
+        case ColumnDataType::TIMESTAMP:
+            return absl::StrFormat(
+                "TIMESTAMP '%04d-%02d-%02d %02d:%02d:%02d.%06d+00'",
+                1 + rng_() % 9999, 1 + rng_() % 12, 1 + rng_() % 28,
+                rng_() % 24, rng_() % 60, rng_() % 60, rng_() % 1000000);
+        default:
+            return "NULL";
+    }
+}
+
+std::string ValueGenerator::characters() {
+    std::string value(rng_() % (max_length_ + 1), ' ');
+    for (char& c : value) {
+        c = kAlphabet[rng_() % (sizeof(kAlphabet) - 1)];
+    }
+    return value;
+}
+
+std::string insertStatement(const CreateTable& create_table, int rows,
+    ValueGenerator* generator) {
+    std::vector<const Column*> columns;
+    for (const Column& column : create_table.primarykeys()) {
+        columns.push_back(&column);
+    }
+    for (const Column& column : create_table.nonprimarykeys()) {
+        columns.push_back(&column);
+    }
+
+    std::vector<std::string> names;
+    for (const Column* column : columns) {
+        names.push_back(column->columnname());
+    }
+    std::vector<std::string> values;
+    for (int row = 0; row < rows; ++row) {
+        std::vector<std::string> row_values;
+        for (const Column* column : columns) {
+            row_values.push_back(generator->literal(*column));
+        }
+        values.push_back(absl::StrCat("(", absl::StrJoin(row_values, ", "),
+            ")"));
+    }
+    return absl::StrCat("INSERT INTO ", create_table.tablename(), " (",
+        absl::StrJoin(names, ", "), ") VALUES ", absl::StrJoin(values, ", "));
+}
+
+}  // namespace spanner_emulator_fuzzer
@@ -0,0 +1,67 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#ifndef SRC_FUZZ_PROTOBUF_UTILS_SPANNER_EMULATOR_VALUE_GENERATOR_H
+#define SRC_FUZZ_PROTOBUF_UTILS_SPANNER_EMULATOR_VALUE_GENERATOR_H
+
+#include "src/fuzz/protobufs/create_table.pb.h"
+
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace spanner_emulator_fuzzer {
+
+// Every valid STRING and BYTES length is at least 1, so values up to this
+// long fit any column toString renders.
+constexpr int kMaxValueLength = 1;
+
+// Generates SQL literals for the columns of a CreateTable, for DML that
+// writes rows into tables rendered by toString. Values are deterministic for
+// a seed, so an input writes the same rows every time it runs.
+class ValueGenerator {
+ public:
+    // STRING and BYTES values are at most max_length characters long, which
+    // callers keep within the column's declared length.
+    ValueGenerator(uint64_t seed, int max_length)
+        : rng_(seed), max_length_(max_length) {}
+
+    // A literal for the column, "PENDING_COMMIT_TIMESTAMP()" for TIMESTAMP
+    // columns that allow commit timestamps, and sometimes NULL for nullable
+    // columns.
+    std::string literal(const spanner_ddl::Column& column);
+
+    // A non-NULL literal of the type.
+    std::string literal(const spanner_ddl::ColumnDataType& data_type);
+
+ private:
+    std::string scalarLiteral(spanner_ddl::ColumnDataType::ScalarType type);
+    std::string characters();
+
+    std::mt19937_64 rng_;
+    int max_length_;
+};
+
+// Whether writes to the column can use PENDING_COMMIT_TIMESTAMP().
+bool isCommitTimestampColumn(const spanner_ddl::Column& column);
+
+// "INSERT INTO <table> (<columns>) VALUES (...), ..." with rows rows of
+// generated values, key columns first.
+std::string insertStatement(const spanner_ddl::CreateTable& create_table,
+    int rows, ValueGenerator* generator);
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif // SRC_FUZZ_PROTOBUF_UTILS_SPANNER_EMULATOR_VALUE_GENERATOR_H
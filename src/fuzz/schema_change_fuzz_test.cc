@@ -0,0 +1,296 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+#include "libprotobuf_mutator/src/libfuzzer/libfuzzer_macro.h"
+
+#include "src/fuzz/protobufs/alter_table.pb.h"
+#include "src/fuzz/protobufs/create_table.pb.h"
+#include "src/fuzz/protobufs/spanner_ddl.pb.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_proto_to_string.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_validator.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_value_generator.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "src/fuzz/oss_fuzz.h"
+#include "src/fuzz/utils/deadline.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/fuzz_target.h"
+#include "src/fuzz/utils/harness_config.h"
+#include "src/fuzz/utils/input_profile.h"
+#include "src/fuzz/utils/latency_stats.h"
+#include "src/fuzz/utils/outcome_features.h"
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "zetasql/base/logging.h"
+#include "google/cloud/spanner/client.h"
+
+using ::google::cloud::Status;
+using ::google::cloud::StatusCode;
+using ::google::cloud::spanner::Client;
+using ::google::cloud::spanner::Database;
+using spanner_ddl::AlterTable;
+using spanner_ddl::CreateTable;
+using spanner_ddl::SchemaChange;
+using ::spanner_emulator_fuzzer::DDLValidity;
+using ::spanner_emulator_fuzzer::EmulatorHarness;
+using ::spanner_emulator_fuzzer::InputProfile;
+using ::spanner_emulator_fuzzer::InputRunner;
+using ::spanner_emulator_fuzzer::LatencyStats;
+using ::spanner_emulator_fuzzer::OutcomeFeatures;
+using ::spanner_emulator_fuzzer::ValueGenerator;
+
+// Writers keep inserting into the input's table while its alterations are
+// applied. Each writer commits kBaselineCommits transactions before the first
+// alteration, so every input has latencies to compare against.
+constexpr int kWriters = 4;
+constexpr int kBaselineCommits = 2;
+constexpr int kRowsPerCommit = 1;
+// Bounds the time one input spends in schema changes.
+constexpr size_t kMaxAlterations = 4;
+
+// Accumulated over all inputs and printed as the "schema change" report
+// section. A write is "during" a schema change if it started while an
+// UpdateDatabaseDdl call was outstanding.
+struct SchemaChangeStats {
+  LatencyStats writes_outside;
+  LatencyStats writes_during;
+  LatencyStats schema_changes;
+  std::atomic<int64_t> schema_changes_failed{0};
+  std::atomic<int64_t> rows_checked{0};
+
+  std::string StatsString() const {
+    std::string out = absl::StrCat(
+        "writes outside schema changes: ", writes_outside.Summary(), "\n",
+        "writes during schema changes: ", writes_during.Summary(), "\n",
+        "schema changes applied: ", schema_changes.Summary(), "\n",
+        "schema changes failed: ", schema_changes_failed.load(), "\n",
+        "rows checked after schema changes: ", rows_checked.load(), "\n");
+    absl::Duration outside_p99 = writes_outside.Percentile(99);
+    if (writes_during.count() > 0 && outside_p99 > absl::ZeroDuration()) {
+      absl::StrAppendFormat(&out, "write p99 during / outside: %.2fx\n",
+                            absl::FDivDuration(writes_during.Percentile(99),
+                                               outside_p99));
+    }
+    return out;
+  }
+};
+
+// Rows the writers of one input committed. A commit that timed out may or
+// may not have been applied, so its rows are only counted as uncertain.
+struct CommittedRows {
+  std::atomic<int64_t> confirmed{0};
+  std::atomic<int64_t> uncertain{0};
+};
+
+SchemaChangeStats* CreateSchemaChangeStats(EmulatorHarness* harness) {
+  auto* stats = new SchemaChangeStats;
+  harness->AddReportSection("schema change",
+                            [stats] { return stats->StatsString(); });
+  return stats;
+}
+
+// Commits DML inserts until stop is set, counting down baseline once the
+// first kBaselineCommits commits are done. Inserts written against the
+// original schema may start failing once a column is dropped or changed.
+// Every commit's status is appended to statuses, which the caller records as
+// outcomes once the writers are joined, since OutcomeFeatures is not
+// thread-safe.
+void RunWriter(const CreateTable& createTable, Client client, uint64_t seed,
+               const std::atomic<bool>& schema_changing,
+               const std::atomic<bool>& stop, absl::BlockingCounter* baseline,
+               CommittedRows* committed, SchemaChangeStats* stats,
+               std::vector<Status>* statuses) {
+  ValueGenerator generator(seed, spanner_emulator_fuzzer::kMaxValueLength);
+  absl::Duration deadline =
+      spanner_emulator_fuzzer::GetHarnessConfig().rpc_deadline;
+  for (int commits = 1; !stop.load(); ++commits) {
+    std::string insert = spanner_emulator_fuzzer::insertStatement(
+        createTable, kRowsPerCommit, &generator);
+    bool during = schema_changing.load();
+    absl::Time start = absl::Now();
+    Status status =
+        spanner_emulator_fuzzer::CommitDml(client, std::move(insert), deadline);
+    absl::Duration latency = absl::Now() - start;
+    (during || schema_changing.load() ? stats->writes_during
+                                      : stats->writes_outside)
+        .Record(latency);
+    if (status.ok()) {
+      committed->confirmed += kRowsPerCommit;
+    } else if (status.code() == StatusCode::kDeadlineExceeded) {
+      committed->uncertain += kRowsPerCommit;
+    }
+    statuses->push_back(std::move(status));
+    if (commits == kBaselineCommits) baseline->DecrementCount();
+  }
+}
+
+// Reads back every row of the table after the schema changes. Returns the
+// number of rows read, or the status of the failed read.
+google::cloud::StatusOr<int64_t> CountRows(Client client,
+                                           const std::string& table_name) {
+  auto rows = std::make_shared<int64_t>(0);
+  Status status = spanner_emulator_fuzzer::RunWithDeadline(
+      [client, table_name, rows]() mutable {
+        auto result = client.ExecuteQuery(google::cloud::spanner::SqlStatement(
+            absl::StrCat("SELECT * FROM ", table_name)));
+        for (auto const& row : result) {
+          if (!row) return row.status();
+          ++*rows;
+        }
+        return Status();
+      },
+      spanner_emulator_fuzzer::GetHarnessConfig().rpc_deadline);
+  if (!status.ok()) return status;
+  return *rows;
+}
+
+// Creates the input's table, starts writers, applies the input's alterations
+// to the table one UpdateDatabaseDdl call at a time while the writers keep
+// committing, and then checks that every committed row can still be read.
+// A row count outside what the writers committed aborts the process so the
+// input is saved as a crash.
+int RunInput(const SchemaChange& schemaChange, EmulatorHarness& harness,
+             SchemaChangeStats* stats, OutcomeFeatures* features,
+             InputProfile* profile) {
+  try {
+    const CreateTable& createTable = schemaChange.createtable();
+    if (spanner_emulator_fuzzer::validate(createTable) != DDLValidity::kValid) {
+      return 0;
+    }
+    std::string createTableDDLStatement = toString(createTable);
+    std::vector<std::string> alterations;
+    for (const AlterTable& input : schemaChange.alterations()) {
+      if (alterations.size() == kMaxAlterations) break;
+      // Alterations always target the input's table, which the mutator would
+      // otherwise rarely name.
+      AlterTable alteration = input;
+      alteration.set_tablename(createTable.tablename());
+      std::string statement = toString(alteration);
+      if (!statement.empty()) alterations.push_back(std::move(statement));
+    }
+    if (alterations.empty()) return 0;
+
+    Database database = harness.NewDatabase();
+    Status status;
+    {
+      InputProfile::ScopedPhase phase(profile, "create_database");
+      status = harness.CreateDatabase(database, {createTableDDLStatement});
+    }
+    if (!status.ok()) {
+      spanner_emulator_fuzzer::RecordOutcome(features, status);
+      return 0;
+    }
+
+    Client client = harness.MakeClient(database);
+    uint64_t seed = std::hash<std::string>()(createTableDDLStatement);
+    std::atomic<bool> schema_changing{false};
+    std::atomic<bool> stop{false};
+    absl::BlockingCounter baseline(kWriters);
+    CommittedRows committed;
+    std::vector<std::vector<Status>> writer_statuses(kWriters);
+    std::vector<std::thread> writers;
+    {
+      InputProfile::ScopedPhase phase(profile, "baseline_writes");
+      for (int i = 0; i < kWriters; ++i) {
+        writers.emplace_back([&, i] {
+          RunWriter(createTable, client, seed + i, schema_changing, stop,
+                    &baseline, &committed, stats, &writer_statuses[i]);
+        });
+      }
+      baseline.Wait();
+    }
+
+    {
+      InputProfile::ScopedPhase phase(profile, "schema_changes");
+      schema_changing = true;
+      for (const std::string& alteration : alterations) {
+        absl::Time start = absl::Now();
+        status = harness.UpdateDatabase(database, {alteration});
+        if (status.ok()) {
+          stats->schema_changes.Record(absl::Now() - start);
+        } else {
+          ++stats->schema_changes_failed;
+        }
+        spanner_emulator_fuzzer::RecordOutcome(features, status);
+      }
+      schema_changing = false;
+      stop = true;
+      for (std::thread& writer : writers) writer.join();
+    }
+    for (const std::vector<Status>& statuses : writer_statuses) {
+      for (const Status& writer_status : statuses) {
+        spanner_emulator_fuzzer::RecordOutcome(features, writer_status);
+      }
+    }
+
+    {
+      InputProfile::ScopedPhase phase(profile, "read_back");
+      auto rows = CountRows(client, createTable.tablename());
+      if (rows) {
+        stats->rows_checked += *rows;
+        int64_t confirmed = committed.confirmed.load();
+        int64_t uncertain = committed.uncertain.load();
+        if (*rows < confirmed || *rows > confirmed + uncertain) {
+          LOG(ERROR) << "Read " << *rows << " rows after schema changes, but "
+                     << confirmed << " rows were committed and " << uncertain
+                     << " more may have been";
+          std::abort();
+        }
+      } else {
+        spanner_emulator_fuzzer::RecordOutcome(features, rows.status());
+      }
+    }
+
+    InputProfile::ScopedPhase phase(profile, "drop_database");
+    harness.DropDatabase(database);
+    return 0;
+  } catch (std::exception const& ex) {
+    LOG(ERROR) << "Standard exception raised: " << ex.what();
+    return 1;
+  }
+}
+
+DEFINE_PROTO_FUZZER(const SchemaChange& schemaChange) {
+  #ifdef __OSS_FUZZ__
+    static bool Initialized = spanner_emulator_fuzzer::DoOssFuzzInit();
+    if (!Initialized) { std::abort(); }
+  #endif
+
+  static EmulatorHarness* harness = EmulatorHarness::Default();
+  if (harness == nullptr) { std::abort(); }
+  static SchemaChangeStats* schema_change_stats =
+      CreateSchemaChangeStats(harness);
+  static OutcomeFeatures* outcome_features =
+      spanner_emulator_fuzzer::CreateOutcomeFeatures(harness);
+  static InputRunner runner(harness);
+
+  runner.Run(schemaChange, [&](InputProfile* profile) {
+    return RunInput(schemaChange, *harness, schema_change_stats,
+                    outcome_features, profile);
+  });
+}
@@ -15,104 +15,173 @@
 #include <cstdlib>
 #include <iostream>
 #include <stdexcept>
+#include <utility>
 #include "src/fuzz/oss_fuzz.h"
+#include "src/fuzz/utils/database_snapshot.h"
+#include "src/fuzz/utils/deadline.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/fuzz_target.h"
+#include "src/fuzz/utils/harness_config.h"
+#include "src/fuzz/utils/input_profile.h"
+#include "src/fuzz/utils/outcome_features.h"
 
 #include "zetasql/base/logging.h"
-#include "frontend/server/server.h"
 #include "google/cloud/spanner/client.h"
-#include "google/cloud/spanner/create_instance_request_builder.h"
-#include "google/cloud/spanner/database_admin_client.h"
-#include "google/cloud/spanner/instance_admin_client.h"
-
-using ::google::spanner::emulator::frontend::Server;
-using ::google::cloud::future;
-using ::google::cloud::StatusOr;
-using ::google::cloud::spanner::DatabaseAdminClient;
-using ::google::cloud::spanner::v0::ConnectionOptions;
-
-const std::string server_address = "localhost:1234";
-
-extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size) {
-  #ifdef __OSS_FUZZ__
-    static bool Initialized = spanner_emulator_fuzzer::DoOssFuzzInit();
-    if (!Initialized) { std::abort(); }
-  #endif
-
-  Server::Options options;
-  options.server_address = server_address;
-  std::unique_ptr<Server> server = Server::Create(options);
-  if (!server) {
-    return EXIT_FAILURE;
+#include "google/cloud/spanner/mutations.h"
+#include "absl/strings/substitute.h"
+#include "absl/synchronization/mutex.h"
+
+using ::google::cloud::spanner::Client;
+using ::google::cloud::spanner::Database;
+using ::google::cloud::spanner::InsertMutationBuilder;
+using ::google::cloud::spanner::Mutations;
+using ::google::cloud::spanner::Transaction;
+using ::spanner_emulator_fuzzer::DatabaseSnapshot;
+using ::spanner_emulator_fuzzer::EmulatorHarness;
+using ::spanner_emulator_fuzzer::InputProfile;
+using ::spanner_emulator_fuzzer::InputRunner;
+using ::spanner_emulator_fuzzer::OutcomeFeatures;
+
+// Creates and seeds the database every input runs its query against, and
+// captures it so that inputs cannot see each other's writes. Returns nullptr
+// if the emulator could not be set up.
+DatabaseSnapshot* CreateSnapshot() {
+  EmulatorHarness* harness = EmulatorHarness::Default();
+  if (harness == nullptr) {
+    return nullptr;
   }
 
-  LOG(INFO) << "Server Up, Executing Test Query";
-
-  try {
-    // This is the connection to the emulator.
-    ConnectionOptions emulator_connection;
-    emulator_connection.set_endpoint(server_address)
-        .set_credentials(grpc::InsecureChannelCredentials());
-
-    // First we create an instance to create our database on.
-    google::cloud::spanner::Instance instance("emulator", "emulator");
-    google::cloud::spanner::InstanceAdminClient instance_client(
-        google::cloud::spanner::MakeInstanceAdminConnection(
-            emulator_connection));
-
-    auto instance_or = instance_client.CreateInstance(
-            google::cloud::spanner::CreateInstanceRequestBuilder(instance,
-                                                                 "emulator")
-                .SetDisplayName("emulator")
-                .SetNodeCount(1)
-                .SetLabels({{"label-key", "label-value"}})
-                .Build())
-                .get();
-    if (!instance_or) {
-      throw std::runtime_error(instance_or.status().message());
-    }
-    LOG(INFO) << "Created instance [" << instance << "]";
-
-    // Then we create a simple database.
-    google::cloud::spanner::Database database(instance, "test-db");
-
-    auto admin_client =
-        DatabaseAdminClient(google::cloud::spanner::MakeDatabaseAdminConnection(
-            emulator_connection));
-    auto db_or =
-        admin_client.CreateDatabase(database, {R"sdl(
+  Database database = harness->NewDatabase();
+  auto status = harness->CreateDatabase(database, {R"sdl(
           CREATE TABLE Singers (
               SingerId   INT64 NOT NULL,
               FirstName  STRING(1024),
               LastName   STRING(1024),
               SingerInfo BYTES(MAX)
           ) PRIMARY KEY (SingerId))sdl",
-                                               R"sdl(
+                                                   R"sdl(
           CREATE TABLE Albums (
               SingerId     INT64 NOT NULL,
               AlbumId      INT64 NOT NULL,
               AlbumTitle   STRING(MAX)
           ) PRIMARY KEY (SingerId, AlbumId),
-              INTERLEAVE IN PARENT Singers ON DELETE CASCADE)sdl"})
-            .get();
-    if (!db_or) throw std::runtime_error(db_or.status().message());
-    LOG(INFO) << "Created database [" << database << "]";
+              INTERLEAVE IN PARENT Singers ON DELETE CASCADE)sdl"});
+  if (!status.ok()) {
+    LOG(ERROR) << "Failed to create database: " << status.message();
+    return nullptr;
+  }
+  LOG(INFO) << "Created database [" << database << "]";
+
+  Client client = harness->MakeClient(database);
+  auto commit = client.Commit(Mutations{
+      InsertMutationBuilder("Singers", {"SingerId", "FirstName", "LastName"})
+          .EmplaceRow(1, "Marc", "Richards")
+          .EmplaceRow(2, "Catalina", "Smith")
+          .Build(),
+      InsertMutationBuilder("Albums", {"SingerId", "AlbumId", "AlbumTitle"})
+          .EmplaceRow(1, 1, "Total Junk")
+          .EmplaceRow(2, 1, "Green")
+          .Build()});
+  if (!commit) {
+    LOG(ERROR) << "Failed to seed database: " << commit.status().message();
+    return nullptr;
+  }
 
-    google::cloud::spanner::Client client(
-        google::cloud::spanner::MakeConnection(database, emulator_connection));
+  auto snapshot = DatabaseSnapshot::Capture(harness, database);
+  if (!snapshot) {
+    LOG(ERROR) << "Failed to capture database: "
+               << snapshot.status().message();
+    return nullptr;
+  }
+  return new DatabaseSnapshot(*std::move(snapshot));
+}
 
-    std::string query = absl::Substitute("INSERT INTO Singers (FirstName) VALUES ($0)", std::string((char*)Data, Size));
+// Queries still running on the snapshot, including those that missed their
+// deadline. Until such a query returns, its transaction holds locks on the
+// seeded rows that can make the next input's query wait or abort.
+struct RunningQueries {
+  absl::Mutex mu;
+  int count ABSL_GUARDED_BY(mu) = 0;
+};
+
+// Runs a single input's query inside a transaction over snapshot that is
+// rolled back afterwards, recording each step in profile and its result in
+// features. A query left running by an earlier input is waited for first; if
+// it is still running after the RPC deadline, this input's result is not
+// recorded, since it may only reflect that query's locks. snapshot and
+// running must outlive the process since a query that misses its deadline
+// keeps running.
+int RunInput(const std::string& input, DatabaseSnapshot* snapshot,
+             RunningQueries* running, OutcomeFeatures* features,
+             InputProfile* profile) {
+  try {
+    std::string query = absl::Substitute("INSERT INTO Singers (FirstName) VALUES ($0)", input);
+    absl::Duration deadline =
+        spanner_emulator_fuzzer::GetHarnessConfig().rpc_deadline;
+
+    bool isolated = true;
+    {
+      absl::MutexLock lock(&running->mu);
+      if (running->count > 0) {
+        InputProfile::ScopedPhase phase(profile, "wait_for_previous_query");
+        isolated = running->mu.AwaitWithTimeout(
+            absl::Condition(+[](int* count) { return *count == 0; },
+                            &running->count),
+            deadline);
+      }
+      ++running->count;
+    }
 
-    client.ExecuteQuery(
-        google::cloud::spanner::SqlStatement(query)
-    );
+    InputProfile::ScopedPhase phase(profile, "execute_query");
+    auto status = spanner_emulator_fuzzer::RunWithDeadline(
+        [snapshot, running, query] {
+          auto result = snapshot->RunIsolated(
+              [&query](Client& client, Transaction transaction) {
+                auto rows = client.ExecuteQuery(
+                    transaction, google::cloud::spanner::SqlStatement(query));
+                for (auto const& row : rows) {
+                  if (!row) return row.status();
+                }
+                return google::cloud::Status();
+              });
+          absl::MutexLock lock(&running->mu);
+          --running->count;
+          return result;
+        },
+        deadline);
+    if (status.code() == google::cloud::StatusCode::kDeadlineExceeded) {
+      LOG(WARNING) << "Query exceeded its deadline: " << query;
+    }
+    if (isolated) {
+      spanner_emulator_fuzzer::RecordOutcome(features, status);
+    } else {
+      LOG(WARNING) << "Not recording the result of a query that ran while "
+                   << "an earlier one was still running";
+    }
 
     return 0;
   } catch (std::exception const& ex) {
     LOG(ERROR) << "Standard exception raised: " << ex.what();
     return 1;
   }
+}
 
-  server->Shutdown();
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size) {
+  #ifdef __OSS_FUZZ__
+    static bool Initialized = spanner_emulator_fuzzer::DoOssFuzzInit();
+    if (!Initialized) { std::abort(); }
+  #endif
 
-  return 0;  
+  static DatabaseSnapshot* snapshot = CreateSnapshot();
+  if (snapshot == nullptr) { std::abort(); }
+  static RunningQueries* running_queries = new RunningQueries;
+  static OutcomeFeatures* outcome_features =
+      spanner_emulator_fuzzer::CreateOutcomeFeatures(EmulatorHarness::Default());
+  static InputRunner runner(EmulatorHarness::Default());
+
+  std::string input((char*)Data, Size);
+  return runner.Run(input, [&](InputProfile* profile) {
+    return RunInput(input, snapshot, running_queries, outcome_features,
+                    profile);
+  });
 }
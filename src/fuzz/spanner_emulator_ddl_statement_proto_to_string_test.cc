@@ -16,8 +16,10 @@
 
 #include <string>
 
+#include "src/fuzz/protobufs/alter_table.pb.h"
 #include "src/fuzz/protobufs/create_table.pb.h"
 #include "src/fuzz/protobufs/spanner_ddl.pb.h"
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_feature_stats.h"
 #include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_proto_to_string.h"
 #include "gtest/gtest.h"
 #include <google/protobuf/repeated_field.h>
@@ -29,8 +31,12 @@
 using spanner_ddl::SpannerFuzzingStatements;
 using spanner_ddl::SpannerDDLStatement;
 using spanner_ddl::CreateTable;
+using spanner_ddl::AlterTable;
+using spanner_ddl::AlterColumn;
+using spanner_ddl::SetColumnOptions;
 using spanner_ddl::Column;
 using spanner_ddl::ColumnDataType;
+using spanner_emulator_fuzzer::ddlFeatureStats;
 
 //TODO: add test that creates a table in the emulator using a protobuf
 //TODO: add more to this test as more APIs are added
@@ -144,6 +150,53 @@ TEST(DDLStatementProtoToString, CreateTableToString) {
     );
 }
 
+TEST(DDLStatementProtoToString, AlterTableToString) {
+    AlterTable alter_table;
+    alter_table.set_tablename("testTable");
+    // an ALTER TABLE without an alteration is not rendered
+    EXPECT_EQ(toString(alter_table), "");
+
+    Column* column = alter_table.mutable_addcolumn();
+    column->set_columnname("testColumn");
+    ColumnDataType* column_data_type = column->mutable_columndatatype();
+    column_data_type->set_scalartype(ColumnDataType::BYTES);
+    column_data_type->set_length(0);
+    column_data_type->set_lengthtype(ColumnDataType::MAX);
+    column_data_type->set_isarray(true);
+    column->set_isnotnull(false);
+    column->set_allowcommittimestamp(false);
+    EXPECT_EQ(toString(alter_table),
+        "ALTER TABLE testTable ADD COLUMN testColumn ARRAY< BYTES( MAX ) >  "
+        "OPTIONS ( allow_commit_timestamp = null )");
+
+    alter_table.set_dropcolumn("testColumn");
+    EXPECT_EQ(toString(alter_table),
+        "ALTER TABLE testTable DROP COLUMN testColumn");
+
+    AlterColumn* alter_column = alter_table.mutable_altercolumn();
+    alter_column->set_columnname("testColumn");
+    column_data_type = alter_column->mutable_columndatatype();
+    column_data_type->set_scalartype(ColumnDataType::STRING);
+    column_data_type->set_length(9);
+    column_data_type->set_lengthtype(ColumnDataType::BOUND);
+    column_data_type->set_isarray(false);
+    alter_column->set_isnotnull(true);
+    EXPECT_EQ(toString(alter_table),
+        "ALTER TABLE testTable ALTER COLUMN testColumn STRING( 10 ) NOT NULL");
+
+    SetColumnOptions* set_column_options =
+        alter_table.mutable_setcolumnoptions();
+    set_column_options->set_columnname("testColumn");
+    set_column_options->set_allowcommittimestamp(true);
+    EXPECT_EQ(toString(alter_table),
+        "ALTER TABLE testTable ALTER COLUMN testColumn "
+        "SET OPTIONS ( allow_commit_timestamp = true )");
+
+    SpannerDDLStatement statement;
+    *statement.mutable_altertable() = alter_table;
+    EXPECT_EQ(toString(statement), toString(alter_table));
+}
+
 TEST(DDLStatementProtoToString, TableColumnsToStringTest) {
     CreateTable create_table;
 
@@ -475,3 +528,39 @@ TEST(DDLStatementProtoToString, ColumnOrientationTest) {
     column.set_orientation(Column::DESC);
     EXPECT_EQ(toString(column.orientation()), "DESC");
 }
+
+TEST(DDLStatementProtoToString, RecordsGeneratedFeatures) {
+    ddlFeatureStats().clear();
+
+    CreateTable create_table;
+    create_table.set_tablename("testTable");
+    Column* column = create_table.add_primarykeys();
+    column->set_columnname("testColumn");
+    ColumnDataType* column_data_type = column->mutable_columndatatype();
+    column_data_type->set_scalartype(ColumnDataType::STRING);
+    column_data_type->set_length(-3);
+    column_data_type->set_lengthtype(ColumnDataType::BOUND);
+    column_data_type->set_isarray(true);
+    column->set_isnotnull(true);
+    column->set_allowcommittimestamp(true);
+    column->set_orientation(Column::ASC);
+
+    // Rendering alone records nothing.
+    toString(create_table);
+    EXPECT_NE(ddlFeatureStats().StatsString().find("tables: 0\n"),
+        std::string::npos);
+
+    recordFeatures(create_table);
+    std::string stats = ddlFeatureStats().StatsString();
+    EXPECT_NE(stats.find("tables: 1\n"), std::string::npos);
+    EXPECT_NE(stats.find("primary keys: 1=1\n"), std::string::npos);
+    EXPECT_NE(stats.find("columns: 1=1\n"), std::string::npos);
+    EXPECT_NE(stats.find("STRING              0          1          1          1"),
+        std::string::npos);
+    // BOUND lengths are rendered as abs(length) + 1.
+    EXPECT_NE(stats.find("length BOUND: 1 [4,8)=1\n"), std::string::npos);
+
+    ddlFeatureStats().clear();
+    EXPECT_NE(ddlFeatureStats().StatsString().find("tables: 0\n"),
+        std::string::npos);
+}
@@ -0,0 +1,139 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/protobufs/utils/spanner_emulator_ddl_statement_validator.h"
+
+#include "src/fuzz/protobufs/create_table.pb.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+using spanner_ddl::CreateTable;
+using spanner_ddl::Column;
+using spanner_ddl::ColumnDataType;
+using spanner_emulator_fuzzer::DDLValidationStats;
+using spanner_emulator_fuzzer::DDLValidity;
+using spanner_emulator_fuzzer::validate;
+
+Column* addColumn(const std::string& name, ColumnDataType::ScalarType type,
+    google::protobuf::RepeatedPtrField<Column>* columns) {
+    Column* column = columns->Add();
+    column->set_columnname(name);
+    ColumnDataType* data_type = column->mutable_columndatatype();
+    data_type->set_isarray(false);
+    data_type->set_scalartype(type);
+    data_type->set_length(10);
+    data_type->set_lengthtype(ColumnDataType::BOUND);
+    column->set_isnotnull(false);
+    column->set_allowcommittimestamp(false);
+    column->set_orientation(Column::ASC);
+    return column;
+}
+
+CreateTable validTable() {
+    CreateTable create_table;
+    create_table.set_tablename("Singers");
+    addColumn("SingerId", ColumnDataType::INT64,
+        create_table.mutable_primarykeys());
+    addColumn("Name", ColumnDataType::STRING,
+        create_table.mutable_nonprimarykeys());
+    return create_table;
+}
+
+TEST(DDLStatementValidator, AcceptsValidTable) {
+    EXPECT_EQ(validate(validTable()), DDLValidity::kValid);
+}
+
+TEST(DDLStatementValidator, RejectsInvalidIdentifiers) {
+    CreateTable create_table = validTable();
+    create_table.set_tablename("");
+    EXPECT_EQ(validate(create_table), DDLValidity::kInvalidIdentifier);
+
+    create_table = validTable();
+    create_table.mutable_nonprimarykeys(0)->set_columnname("1Name");
+    EXPECT_EQ(validate(create_table), DDLValidity::kInvalidIdentifier);
+
+    create_table = validTable();
+    create_table.mutable_nonprimarykeys(0)->set_columnname("Na me");
+    EXPECT_EQ(validate(create_table), DDLValidity::kInvalidIdentifier);
+}
+
+// "PRIMARY KEY ()" declares a table holding at most one row, which Spanner
+// accepts.
+TEST(DDLStatementValidator, AcceptsEmptyPrimaryKey) {
+    CreateTable create_table = validTable();
+    create_table.clear_primarykeys();
+    EXPECT_EQ(validate(create_table), DDLValidity::kValid);
+}
+
+TEST(DDLStatementValidator, RejectsDuplicateColumnNames) {
+    CreateTable create_table = validTable();
+    create_table.mutable_nonprimarykeys(0)->set_columnname("SINGERID");
+    EXPECT_EQ(validate(create_table), DDLValidity::kDuplicateColumnName);
+}
+
+TEST(DDLStatementValidator, RejectsArrayPrimaryKey) {
+    CreateTable create_table = validTable();
+    create_table.mutable_primarykeys(0)->mutable_columndatatype()
+        ->set_isarray(true);
+    EXPECT_EQ(validate(create_table), DDLValidity::kArrayPrimaryKey);
+}
+
+TEST(DDLStatementValidator, ChecksOnlyUnboundLengths) {
+    CreateTable create_table = validTable();
+    ColumnDataType* data_type =
+        create_table.mutable_nonprimarykeys(0)->mutable_columndatatype();
+    data_type->set_length(-5);
+    EXPECT_EQ(validate(create_table), DDLValidity::kValid);
+
+    data_type->set_lengthtype(ColumnDataType::UNBOUND);
+    EXPECT_EQ(validate(create_table), DDLValidity::kInvalidLength);
+
+    data_type->set_length(0);
+    EXPECT_EQ(validate(create_table), DDLValidity::kInvalidLength);
+
+    data_type->set_length(2621440);
+    EXPECT_EQ(validate(create_table), DDLValidity::kValid);
+
+    data_type->set_scalartype(ColumnDataType::INT64);
+    data_type->set_length(-5);
+    EXPECT_EQ(validate(create_table), DDLValidity::kValid);
+}
+
+TEST(DDLStatementValidator, RejectsCommitTimestampOnNonTimestamp) {
+    CreateTable create_table = validTable();
+    Column* column = create_table.mutable_nonprimarykeys(0);
+    column->set_allowcommittimestamp(true);
+    EXPECT_EQ(validate(create_table),
+        DDLValidity::kCommitTimestampOnNonTimestamp);
+
+    column->mutable_columndatatype()->set_scalartype(ColumnDataType::TIMESTAMP);
+    EXPECT_EQ(validate(create_table), DDLValidity::kValid);
+}
+
+TEST(DDLStatementValidator, CountsClassifications) {
+    DDLValidationStats stats;
+    stats.record(DDLValidity::kValid);
+    stats.record(DDLValidity::kInvalidLength);
+    stats.record(DDLValidity::kInvalidLength);
+    stats.recordMisprediction();
+
+    EXPECT_EQ(stats.count(DDLValidity::kValid), 1);
+    EXPECT_EQ(stats.count(DDLValidity::kInvalidLength), 2);
+    EXPECT_EQ(stats.count(DDLValidity::kArrayPrimaryKey), 0);
+    EXPECT_EQ(stats.mispredictions(), 1);
+    EXPECT_NE(stats.StatsString().find("invalid_length"), std::string::npos);
+}
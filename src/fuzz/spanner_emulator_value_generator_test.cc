@@ -0,0 +1,172 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/protobufs/utils/spanner_emulator_value_generator.h"
+
+#include "src/fuzz/protobufs/create_table.pb.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+using spanner_ddl::CreateTable;
+using spanner_ddl::Column;
+using spanner_ddl::ColumnDataType;
+using spanner_emulator_fuzzer::insertStatement;
+using spanner_emulator_fuzzer::isCommitTimestampColumn;
+using spanner_emulator_fuzzer::kMaxValueLength;
+using spanner_emulator_fuzzer::ValueGenerator;
+
+// Enough draws that a literal picked with probability 1/8 shows up.
+constexpr int kDraws = 1000;
+
+Column makeColumn(const std::string& name, ColumnDataType::ScalarType type) {
+    Column column;
+    column.set_columnname(name);
+    ColumnDataType* data_type = column.mutable_columndatatype();
+    data_type->set_isarray(false);
+    data_type->set_scalartype(type);
+    data_type->set_length(10);
+    data_type->set_lengthtype(ColumnDataType::BOUND);
+    column.set_isnotnull(false);
+    column.set_allowcommittimestamp(false);
+    column.set_orientation(Column::ASC);
+    return column;
+}
+
+CreateTable singersTable() {
+    CreateTable create_table;
+    create_table.set_tablename("Singers");
+    *create_table.add_primarykeys() = makeColumn("SingerId",
+        ColumnDataType::INT64);
+    *create_table.add_primarykeys() = makeColumn("Region",
+        ColumnDataType::STRING);
+    *create_table.add_nonprimarykeys() = makeColumn("Name",
+        ColumnDataType::STRING);
+    *create_table.add_nonprimarykeys() = makeColumn("Active",
+        ColumnDataType::BOOL);
+    return create_table;
+}
+
+TEST(ValueGenerator, IsDeterministicPerSeed) {
+    CreateTable create_table = singersTable();
+    ValueGenerator first(42, kMaxValueLength);
+    ValueGenerator second(42, kMaxValueLength);
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(insertStatement(create_table, 3, &first),
+            insertStatement(create_table, 3, &second));
+    }
+
+    ValueGenerator other(43, kMaxValueLength);
+    ValueGenerator again(42, kMaxValueLength);
+    bool differs = false;
+    for (int i = 0; i < 10; ++i) {
+        differs |= insertStatement(create_table, 3, &other) !=
+            insertStatement(create_table, 3, &again);
+    }
+    EXPECT_TRUE(differs);
+}
+
+TEST(ValueGenerator, PendingCommitTimestampOnlyForCommitTimestampColumns) {
+    Column commit_timestamp = makeColumn("Updated", ColumnDataType::TIMESTAMP);
+    commit_timestamp.set_allowcommittimestamp(true);
+    commit_timestamp.set_isnotnull(true);
+    EXPECT_TRUE(isCommitTimestampColumn(commit_timestamp));
+
+    Column array = commit_timestamp;
+    array.mutable_columndatatype()->set_isarray(true);
+    EXPECT_FALSE(isCommitTimestampColumn(array));
+
+    Column not_timestamp = commit_timestamp;
+    not_timestamp.mutable_columndatatype()->set_scalartype(
+        ColumnDataType::INT64);
+    EXPECT_FALSE(isCommitTimestampColumn(not_timestamp));
+
+    Column plain_timestamp = makeColumn("Created", ColumnDataType::TIMESTAMP);
+    plain_timestamp.set_isnotnull(true);
+    EXPECT_FALSE(isCommitTimestampColumn(plain_timestamp));
+
+    ValueGenerator generator(7, kMaxValueLength);
+    for (int i = 0; i < kDraws; ++i) {
+        EXPECT_EQ(generator.literal(commit_timestamp),
+            "PENDING_COMMIT_TIMESTAMP()");
+        std::string array_literal = generator.literal(array);
+        EXPECT_EQ(array_literal.find("PENDING_COMMIT_TIMESTAMP"),
+            std::string::npos) << array_literal;
+        EXPECT_EQ(array_literal.front(), '[');
+        EXPECT_EQ(generator.literal(not_timestamp).find("PENDING"),
+            std::string::npos);
+        EXPECT_EQ(generator.literal(plain_timestamp).rfind("TIMESTAMP '", 0),
+            0u);
+    }
+}
+
+TEST(ValueGenerator, NullOnlyForNullableColumns) {
+    Column nullable = makeColumn("Name", ColumnDataType::STRING);
+    Column not_null = makeColumn("Name", ColumnDataType::STRING);
+    not_null.set_isnotnull(true);
+
+    ValueGenerator generator(11, kMaxValueLength);
+    int nulls = 0;
+    for (int i = 0; i < kDraws; ++i) {
+        EXPECT_NE(generator.literal(not_null), "NULL");
+        if (generator.literal(nullable) == "NULL") ++nulls;
+    }
+    EXPECT_GT(nulls, 0);
+    EXPECT_LT(nulls, kDraws);
+}
+
+TEST(ValueGenerator, KeepsStringsWithinMaxLength) {
+    Column column = makeColumn("Name", ColumnDataType::STRING);
+    column.set_isnotnull(true);
+    ValueGenerator generator(3, kMaxValueLength);
+    for (int i = 0; i < kDraws; ++i) {
+        std::string literal = generator.literal(column);
+        ASSERT_GE(literal.size(), 2u);
+        EXPECT_LE(literal.size() - 2, static_cast<size_t>(kMaxValueLength))
+            << literal;
+    }
+}
+
+TEST(InsertStatement, ListsKeyColumnsFirstInDeclarationOrder) {
+    CreateTable create_table = singersTable();
+    for (int i = 0; i < create_table.nonprimarykeys_size(); ++i) {
+        create_table.mutable_nonprimarykeys(i)->set_isnotnull(true);
+    }
+    ValueGenerator generator(5, kMaxValueLength);
+    std::string insert = insertStatement(create_table, 3, &generator);
+
+    const std::string prefix =
+        "INSERT INTO Singers (SingerId, Region, Name, Active) VALUES (";
+    ASSERT_EQ(insert.substr(0, prefix.size()), prefix) << insert;
+    EXPECT_EQ(insert.back(), ')');
+
+    // Values are integers, booleans and alphanumeric strings, so rows are
+    // the only parenthesized groups.
+    std::string values = insert.substr(prefix.size() - 1);
+    int rows = 0;
+    size_t start = 0;
+    while ((start = values.find('(', start)) != std::string::npos) {
+        size_t end = values.find(')', start);
+        ASSERT_NE(end, std::string::npos);
+        std::string row = values.substr(start + 1, end - start - 1);
+        int separators = 0;
+        for (char c : row) separators += c == ',';
+        EXPECT_EQ(separators, 3) << row;
+        ++rows;
+        start = end;
+    }
+    EXPECT_EQ(rows, 3);
+}
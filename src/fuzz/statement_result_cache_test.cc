@@ -0,0 +1,92 @@
+//
+// Copyright 2020 Google LLC.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <string>
+
+#include "src/fuzz/utils/statement_result_cache.h"
+#include "gtest/gtest.h"
+
+using spanner_emulator_fuzzer::StatementResult;
+using spanner_emulator_fuzzer::StatementResultCache;
+
+TEST(StatementResultCache, ReturnsInsertedResult) {
+    StatementResultCache cache(10, 1 << 20);
+
+    EXPECT_EQ(cache.Lookup("CREATE TABLE t ( a INT64 ) PRIMARY KEY ( a )"),
+        nullptr);
+    cache.Insert("CREATE TABLE t ( a INT64 ) PRIMARY KEY ( a )",
+        StatementResult{3, "invalid"});
+
+    const StatementResult* result =
+        cache.Lookup("CREATE TABLE t ( a INT64 ) PRIMARY KEY ( a )");
+    ASSERT_NE(result, nullptr);
+    EXPECT_EQ(result->status_code, 3);
+    EXPECT_EQ(result->message, "invalid");
+    EXPECT_EQ(cache.Lookup("CREATE TABLE u ( a INT64 ) PRIMARY KEY ( a )"),
+        nullptr);
+
+    EXPECT_EQ(cache.hits(), 1);
+    EXPECT_EQ(cache.misses(), 2);
+    EXPECT_DOUBLE_EQ(cache.hit_rate(), 1.0 / 3);
+}
+
+TEST(StatementResultCache, ReinsertReplacesResult) {
+    StatementResultCache cache(10, 1 << 20);
+
+    cache.Insert("statement", StatementResult{3, "first"});
+    cache.Insert("statement", StatementResult{0, ""});
+
+    EXPECT_EQ(cache.size(), 1);
+    ASSERT_NE(cache.Lookup("statement"), nullptr);
+    EXPECT_EQ(cache.Lookup("statement")->status_code, 0);
+}
+
+TEST(StatementResultCache, EvictsLeastRecentlyUsedEntry) {
+    StatementResultCache cache(2, 1 << 20);
+
+    cache.Insert("a", StatementResult{0, ""});
+    cache.Insert("b", StatementResult{0, ""});
+    // Touching "a" makes "b" the least recently used entry.
+    EXPECT_NE(cache.Lookup("a"), nullptr);
+    cache.Insert("c", StatementResult{0, ""});
+
+    EXPECT_EQ(cache.size(), 2);
+    EXPECT_EQ(cache.evictions(), 1);
+    EXPECT_NE(cache.Lookup("a"), nullptr);
+    EXPECT_EQ(cache.Lookup("b"), nullptr);
+    EXPECT_NE(cache.Lookup("c"), nullptr);
+}
+
+TEST(StatementResultCache, StaysWithinByteBound) {
+    StatementResultCache cache(1000, 4096);
+
+    for (int i = 0; i < 100; ++i) {
+        cache.Insert(std::to_string(i),
+            StatementResult{3, std::string(512, 'x')});
+        EXPECT_LE(cache.bytes(), 4096);
+    }
+    EXPECT_GT(cache.evictions(), 0);
+    EXPECT_NE(cache.Lookup("99"), nullptr);
+}
+
+TEST(StatementResultCache, DisabledCacheStoresNothing) {
+    StatementResultCache cache(0, 0);
+
+    cache.Insert("statement", StatementResult{0, ""});
+
+    EXPECT_EQ(cache.size(), 0);
+    EXPECT_EQ(cache.Lookup("statement"), nullptr);
+}
@@ -0,0 +1,100 @@
+#
+# Copyright 2020 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Compiles a zipped zoneinfo tree into a C++ source file.
+
+Every TZif file in the zip becomes a char array, named by its path in the
+zip, e.g. "America/Los_Angeles". Zones with identical contents, such as
+links, share one array. The table is sorted by name for FindEmbeddedZone in
+src/fuzz/utils/embedded_zoneinfo.cc. The tzdata version is taken from
+tzdata.zi when the zip has one.
+"""
+
+import argparse
+import re
+import sys
+import zipfile
+
+_TZIF_MAGIC = b'TZif'
+_VERSION = re.compile(r'^#\s*version\s+(\S+)')
+
+
+def _literal(data):
+  """Returns data as a C++ string literal, escaping everything that is not
+  printable ASCII. Escapes are 3-digit octal, so a following digit can never
+  be read as part of one."""
+  out = ['"']
+  for byte in data:
+    char = chr(byte)
+    if ' ' <= char <= '~' and char not in '"\\?':
+      out.append(char)
+    else:
+      out.append('\\%03o' % byte)
+    if len(out) % 80 == 0:
+      out.append('"\n    "')
+  out.append('"')
+  return ''.join(out)
+
+
+def main(argv):
+  parser = argparse.ArgumentParser(description=__doc__)
+  parser.add_argument('--output', required=True)
+  parser.add_argument('zip', help='e.g. third_party/zoneinfo/zoneinfo.zip')
+  args = parser.parse_args(argv)
+
+  version = ''
+  zones = {}
+  with zipfile.ZipFile(args.zip) as archive:
+    for name in archive.namelist():
+      if name.endswith('/'):
+        continue
+      data = archive.read(name)
+      if name == 'tzdata.zi':
+        match = _VERSION.match(data.decode('utf-8', 'replace'))
+        if match:
+          version = match.group(1)
+      if data.startswith(_TZIF_MAGIC):
+        zones[name] = data
+
+  if not zones:
+    parser.error('no TZif files in %s' % args.zip)
+
+  blobs = {}
+  for name in sorted(zones):
+    blobs.setdefault(zones[name], len(blobs))
+
+  with open(args.output, 'w') as out:
+    out.write('// Generated by embed_zoneinfo.py, do not edit.\n\n')
+    out.write('#include "src/fuzz/utils/embedded_zoneinfo.h"\n\n')
+    out.write('#include <cstddef>\n\n')
+    out.write('namespace spanner_emulator_fuzzer {\n\nnamespace {\n\n')
+    for data, index in sorted(blobs.items(), key=lambda item: item[1]):
+      out.write('const char kZone%d[] =\n    %s;\n' % (index, _literal(data)))
+    out.write('\n}  // namespace\n\n')
+    out.write('const EmbeddedZone kEmbeddedZones[] = {\n')
+    for name in sorted(zones):
+      index = blobs[zones[name]]
+      out.write('    {"%s", kZone%d, sizeof(kZone%d) - 1},\n' %
+                (name, index, index))
+    out.write('};\n')
+    out.write('const std::size_t kNumEmbeddedZones = %d;\n' % len(zones))
+    out.write('const char kEmbeddedZoneInfoVersion[] = "%s";\n\n' % version)
+    out.write('}  // namespace spanner_emulator_fuzzer\n')
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,123 @@
+#
+# Copyright 2020 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+"""Generates a libFuzzer dictionary from the emulator's DDL grammar.
+
+Token literals are taken from the JavaCC grammar compiled by the emulator's
+javacc_parser rule and keywords from ZetaSQL's keyword table. Extra .dict
+files are merged in as-is, for multi-token sequences such as "ARRAY<" or
+option names like "allow_commit_timestamp" that the grammar treats as plain
+identifiers.
+"""
+
+import argparse
+import re
+import sys
+
+# A double quoted C/Java string literal.
+_STRING_LITERAL = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+# An entry of ZetaSQL's keyword table, e.g. {"interval", kReserved}.
+_ZETASQL_KEYWORD = re.compile(r'\{\s*"([A-Za-z_][A-Za-z0-9_]*)"\s*,')
+# A quoted value in an existing dictionary line, e.g. kw1="INTERLEAVE".
+_DICT_ENTRY = re.compile(r'^\s*(?:[A-Za-z0-9_]+\s*=\s*)?"(.*)"\s*$')
+
+_IDENTIFIER = re.compile(r'^[A-Za-z_][A-Za-z0-9_]*$')
+_PUNCTUATION = re.compile(r'^[^\sA-Za-z0-9]{1,3}$')
+
+
+def _unescape(literal):
+  return bytes(literal, 'utf-8').decode('unicode_escape')
+
+
+def _escape(token):
+  out = []
+  for char in token:
+    if char in '"\\':
+      out.append('\\' + char)
+    elif ' ' <= char <= '~':
+      out.append(char)
+    else:
+      out.append('\\x%02X' % ord(char))
+  return ''.join(out)
+
+
+def grammar_tokens(text):
+  """Returns keywords and punctuation quoted anywhere in a JavaCC grammar.
+
+  Literals embedded in the grammar's C++ actions, such as error messages, are
+  dropped because they contain whitespace or are longer than an operator.
+  """
+  tokens = []
+  for match in _STRING_LITERAL.finditer(text):
+    token = _unescape(match.group(1))
+    if _IDENTIFIER.match(token):
+      # The DDL grammar is case insensitive, upper case matches the docs.
+      tokens.append(token.upper())
+    elif _PUNCTUATION.match(token):
+      tokens.append(token)
+  return tokens
+
+
+def zetasql_keywords(text):
+  return [keyword.upper() for keyword in _ZETASQL_KEYWORD.findall(text)]
+
+
+def dictionary_entries(text):
+  entries = []
+  for line in text.splitlines():
+    if line.lstrip().startswith('#'):
+      continue
+    match = _DICT_ENTRY.match(line)
+    if match:
+      entries.append(_unescape(match.group(1)))
+  return entries
+
+
+def main(argv):
+  parser = argparse.ArgumentParser(description=__doc__)
+  parser.add_argument('--grammar', action='append', default=[],
+                      help='JavaCC grammar to take token literals from')
+  parser.add_argument('--zetasql_keywords', action='append', default=[],
+                      help='ZetaSQL keywords.cc to take keywords from')
+  parser.add_argument('--extra', action='append', default=[],
+                      help='Existing .dict file to merge in')
+  parser.add_argument('--output', required=True)
+  args = parser.parse_args(argv)
+
+  tokens = []
+  for path in args.grammar:
+    with open(path) as f:
+      tokens.extend(grammar_tokens(f.read()))
+  for path in args.zetasql_keywords:
+    with open(path) as f:
+      tokens.extend(zetasql_keywords(f.read()))
+  for path in args.extra:
+    with open(path) as f:
+      tokens.extend(dictionary_entries(f.read()))
+
+  seen = set()
+  with open(args.output, 'w') as out:
+    out.write('# Generated by generate_fuzz_dictionary.py, do not edit.\n')
+    for token in tokens:
+      if token in seen:
+        continue
+      seen.add(token)
+      out.write('"%s"\n' % _escape(token))
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,85 @@
+#!/bin/bash
+#
+# Copyright 2020 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+# Collects an LLVM instrumentation profile for --config=pgo_use and
+# --config=pgo_deps. Builds the fuzz targets, traffic_replay and the
+# benchmarks with --config=pgo_instrument, runs each fuzz target once over its
+# corpus, replays the captured traffic logs and runs short benchmark passes,
+# then merges the raw profiles into pgo/ and writes pgo.bazelrc, which
+# .bazelrc imports. The profile's name carries its hash: Bazel does not track
+# files named only in flags, so a new name is what invalidates cached actions.
+#
+# Usage, from the workspace root:
+#   src/fuzz/tools/pgo_train.sh \
+#       --corpus create_table_fuzz_test=corpus/create_table \
+#       --traffic /tmp/traffic.log
+
+set -euo pipefail
+
+readonly FUZZ_TARGETS=(simple_fuzz_test create_table_fuzz_test)
+readonly BENCHMARKS=(snapshot_restore_benchmark load_generator)
+
+corpora=()
+traffic_logs=()
+while [[ $# -gt 0 ]]; do
+  case "$1" in
+    --corpus) corpora+=("$2"); shift 2 ;;
+    --traffic) traffic_logs+=("$2"); shift 2 ;;
+    *) echo "Unknown argument $1" >&2; exit 1 ;;
+  esac
+done
+if [[ ${#corpora[@]} -eq 0 && ${#traffic_logs[@]} -eq 0 ]]; then
+  echo "Pass at least one --corpus <fuzz_target>=<dir> or --traffic <log>" >&2
+  exit 1
+fi
+
+readonly WORKSPACE="$(pwd)"
+readonly PROFILE_DIR="${WORKSPACE}/pgo"
+readonly RAW_DIR="${PROFILE_DIR}/raw"
+rm -rf "${RAW_DIR}"
+mkdir -p "${RAW_DIR}"
+
+targets=(//src/binary:traffic_replay)
+for target in "${FUZZ_TARGETS[@]}"; do targets+=("//src/fuzz:${target}"); done
+for target in "${BENCHMARKS[@]}"; do targets+=("//src/binary:${target}"); done
+bazel build --config=pgo_instrument "${targets[@]}"
+readonly BIN="$(bazel info --config=pgo_instrument bazel-bin)"
+
+export LLVM_PROFILE_FILE="${RAW_DIR}/%p-%m.profraw"
+
+# -runs=0 executes every corpus input once without mutating.
+for corpus in "${corpora[@]}"; do
+  "${BIN}/src/fuzz/${corpus%%=*}" -runs=0 "${corpus#*=}"
+done
+for log in "${traffic_logs[@]}"; do
+  "${BIN}/src/binary/traffic_replay" --log="${log}"
+done
+"${BIN}/src/binary/snapshot_restore_benchmark" --rows=100,1000 \
+    --iterations=10 --clone_iterations=1
+"${BIN}/src/binary/load_generator" --qps=200,1000 --duration=5s
+
+llvm-profdata merge -output="${PROFILE_DIR}/merged.profdata" \
+    "${RAW_DIR}"/*.profraw
+readonly HASH="$(sha256sum "${PROFILE_DIR}/merged.profdata" | cut -c1-16)"
+readonly PROFILE="${PROFILE_DIR}/spanner_emulator-${HASH}.profdata"
+mv "${PROFILE_DIR}/merged.profdata" "${PROFILE}"
+cat > "${WORKSPACE}/pgo.bazelrc" <<BAZELRC
+# Generated by src/fuzz/tools/pgo_train.sh.
+build:pgo_use --copt=-fprofile-instr-use=${PROFILE}
+build:pgo_deps --per_file_copt=external/.*@-fprofile-instr-use=${PROFILE}
+BAZELRC
+echo "Wrote ${PROFILE} and pgo.bazelrc"
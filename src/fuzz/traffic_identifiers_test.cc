@@ -0,0 +1,122 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <string>
+#include <vector>
+
+#include "src/fuzz/utils/traffic_identifiers.h"
+#include "google/spanner/v1/spanner.pb.h"
+#include "gtest/gtest.h"
+
+using google::spanner::v1::BatchCreateSessionsResponse;
+using google::spanner::v1::BeginTransactionRequest;
+using google::spanner::v1::CommitRequest;
+using google::spanner::v1::DeleteSessionRequest;
+using google::spanner::v1::ExecuteSqlRequest;
+using google::spanner::v1::ReadRequest;
+using google::spanner::v1::Transaction;
+using spanner_emulator_fuzzer::CollectIdentifiers;
+using spanner_emulator_fuzzer::IdentifierMap;
+using spanner_emulator_fuzzer::RemapIdentifiers;
+
+namespace {
+
+const IdentifierMap& capturedIds() {
+    static const IdentifierMap* ids = new IdentifierMap{
+        {"sessions/captured", "sessions/replayed"},
+        {"captured-txn", "replayed-txn"},
+    };
+    return *ids;
+}
+
+}  // namespace
+
+TEST(TrafficIdentifiers, RemapsExecuteSqlSessionAndTransaction) {
+    ExecuteSqlRequest request;
+    request.set_session("sessions/captured");
+    request.mutable_transaction()->set_id("captured-txn");
+    // Statement text and parameter values that happen to equal an id.
+    request.set_sql("sessions/captured");
+    (*request.mutable_params()->mutable_fields())["p"].set_string_value(
+        "captured-txn");
+
+    RemapIdentifiers(capturedIds(), &request);
+
+    EXPECT_EQ(request.session(), "sessions/replayed");
+    EXPECT_EQ(request.transaction().id(), "replayed-txn");
+    EXPECT_EQ(request.sql(), "sessions/captured");
+    EXPECT_EQ(request.params().fields().at("p").string_value(),
+        "captured-txn");
+}
+
+TEST(TrafficIdentifiers, LeavesReadKeysAlone) {
+    ReadRequest request;
+    request.set_session("sessions/captured");
+    request.set_table("captured-txn");
+    request.mutable_key_set()->add_keys()->add_values()->set_string_value(
+        "sessions/captured");
+
+    RemapIdentifiers(capturedIds(), &request);
+
+    EXPECT_EQ(request.session(), "sessions/replayed");
+    EXPECT_EQ(request.table(), "captured-txn");
+    EXPECT_EQ(request.key_set().keys(0).values(0).string_value(),
+        "sessions/captured");
+}
+
+TEST(TrafficIdentifiers, RemapsBeginTransactionAndCommit) {
+    BeginTransactionRequest begin;
+    begin.set_session("sessions/captured");
+    RemapIdentifiers(capturedIds(), &begin);
+    EXPECT_EQ(begin.session(), "sessions/replayed");
+
+    CommitRequest commit;
+    commit.set_session("sessions/captured");
+    commit.set_transaction_id("captured-txn");
+    auto* insert = commit.add_mutations()->mutable_insert();
+    insert->set_table("T");
+    insert->add_columns("Key");
+    insert->add_values()->add_values()->set_string_value("captured-txn");
+
+    RemapIdentifiers(capturedIds(), &commit);
+
+    EXPECT_EQ(commit.session(), "sessions/replayed");
+    EXPECT_EQ(commit.transaction_id(), "replayed-txn");
+    EXPECT_EQ(commit.mutations(0).insert().values(0).values(0).string_value(),
+        "captured-txn");
+}
+
+TEST(TrafficIdentifiers, RemapsSessionNames) {
+    DeleteSessionRequest request;
+    request.set_name("sessions/captured");
+    RemapIdentifiers(capturedIds(), &request);
+    EXPECT_EQ(request.name(), "sessions/replayed");
+}
+
+TEST(TrafficIdentifiers, CollectsSessionsAndTransactionsInOrder) {
+    BatchCreateSessionsResponse sessions;
+    sessions.add_session()->set_name("sessions/a");
+    sessions.add_session()->set_name("sessions/b");
+    std::vector<std::string> ids;
+    CollectIdentifiers(sessions, &ids);
+
+    Transaction transaction;
+    transaction.set_id("txn");
+    CollectIdentifiers(transaction, &ids);
+
+    EXPECT_EQ(ids, (std::vector<std::string>{"sessions/a", "sessions/b",
+        "txn"}));
+}
@@ -0,0 +1,135 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <cstdint>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/fuzz/utils/traffic_log.h"
+#include "absl/time/time.h"
+#include "gtest/gtest.h"
+
+using spanner_emulator_fuzzer::TrafficLogReader;
+using spanner_emulator_fuzzer::TrafficLogWriter;
+using spanner_emulator_fuzzer::TrafficRecord;
+
+namespace {
+
+TrafficRecord makeRecord(TrafficRecord::Kind kind, uint64_t call_id,
+        const std::string& method, absl::Duration timestamp,
+        const std::string& payload) {
+    TrafficRecord record;
+    record.kind = kind;
+    record.call_id = call_id;
+    record.method = method;
+    record.timestamp = timestamp;
+    record.payload = payload;
+    return record;
+}
+
+std::string logPath(const std::string& name) {
+    return ::testing::TempDir() + "/" + name;
+}
+
+}  // namespace
+
+TEST(TrafficLog, RoundTripsRecords) {
+    // Values on both sides of each varint byte boundary, an empty payload and
+    // one with every byte value, and methods interned in between records.
+    std::string binary;
+    for (int i = 0; i < 256; ++i) binary.push_back(static_cast<char>(i));
+    const std::vector<TrafficRecord> records = {
+        makeRecord(TrafficRecord::kRequest, 0,
+            "/google.spanner.v1.Spanner/ExecuteSql", absl::ZeroDuration(), ""),
+        makeRecord(TrafficRecord::kResponse, 127,
+            "/google.spanner.v1.Spanner/ExecuteSql", absl::Nanoseconds(128),
+            binary),
+        makeRecord(TrafficRecord::kRequest, 128,
+            "/google.spanner.v1.Spanner/Commit", absl::Seconds(3), "commit"),
+        makeRecord(TrafficRecord::kResponse, uint64_t{1} << 35,
+            "/google.spanner.v1.Spanner/ExecuteSql", absl::Hours(30),
+            std::string(300, 'x')),
+        makeRecord(TrafficRecord::kRequest,
+            std::numeric_limits<uint64_t>::max(),
+            "/google.spanner.v1.Spanner/Commit", absl::Nanoseconds(16383),
+            "last"),
+    };
+
+    const std::string path = logPath("round_trip.log");
+    {
+        std::unique_ptr<TrafficLogWriter> writer = TrafficLogWriter::Open(path);
+        ASSERT_NE(writer, nullptr);
+        for (const TrafficRecord& record : records) writer->Write(record);
+        writer->Flush();
+    }
+
+    std::unique_ptr<TrafficLogReader> reader = TrafficLogReader::Open(path);
+    ASSERT_NE(reader, nullptr);
+    for (const TrafficRecord& expected : records) {
+        TrafficRecord record;
+        ASSERT_TRUE(reader->Next(&record));
+        EXPECT_EQ(record.kind, expected.kind);
+        EXPECT_EQ(record.call_id, expected.call_id);
+        EXPECT_EQ(record.method, expected.method);
+        EXPECT_EQ(record.timestamp, expected.timestamp);
+        EXPECT_EQ(record.payload, expected.payload);
+    }
+    TrafficRecord record;
+    EXPECT_FALSE(reader->Next(&record));
+}
+
+TEST(TrafficLog, StopsAtTruncatedRecord) {
+    const std::string path = logPath("truncated.log");
+    {
+        std::unique_ptr<TrafficLogWriter> writer = TrafficLogWriter::Open(path);
+        ASSERT_NE(writer, nullptr);
+        writer->Write(makeRecord(TrafficRecord::kRequest, 1, "/m",
+            absl::ZeroDuration(), "complete"));
+        writer->Write(makeRecord(TrafficRecord::kRequest, 2, "/m",
+            absl::ZeroDuration(), std::string(200, 'y')));
+        writer->Flush();
+    }
+    std::string contents;
+    {
+        std::ifstream in(path, std::ios::binary);
+        contents.assign(std::istreambuf_iterator<char>(in),
+            std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), contents.size() - 10);
+    }
+
+    std::unique_ptr<TrafficLogReader> reader = TrafficLogReader::Open(path);
+    ASSERT_NE(reader, nullptr);
+    TrafficRecord record;
+    ASSERT_TRUE(reader->Next(&record));
+    EXPECT_EQ(record.payload, "complete");
+    EXPECT_FALSE(reader->Next(&record));
+}
+
+TEST(TrafficLog, RejectsFilesWithoutMagic) {
+    const std::string path = logPath("not_a_log.log");
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << "NOTALOG1 and more";
+    }
+    EXPECT_EQ(TrafficLogReader::Open(path), nullptr);
+    EXPECT_EQ(TrafficLogReader::Open(logPath("missing.log")), nullptr);
+}
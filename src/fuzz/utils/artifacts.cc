@@ -0,0 +1,63 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/artifacts.h"
+
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <system_error>
+
+#include "zetasql/base/logging.h"
+#include "absl/strings/str_cat.h"
+
+namespace spanner_emulator_fuzzer {
+
+namespace {
+
+bool WriteFile(const std::filesystem::path& path, absl::string_view contents) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(contents.data(), contents.size());
+  return out.good();
+}
+
+}  // namespace
+
+std::string SaveArtifact(absl::string_view dir, absl::string_view kind,
+                         absl::string_view input, absl::string_view report) {
+  namespace fs = std::filesystem;
+  std::error_code error;
+  fs::create_directories(std::string(dir), error);
+  if (error) {
+    LOG(ERROR) << "Cannot create artifact directory " << dir << ": "
+               << error.message();
+    return "";
+  }
+
+  size_t hash = std::hash<std::string>()(std::string(input));
+  fs::path input_path =
+      fs::path(std::string(dir)) / absl::StrCat(kind, "-", absl::Hex(hash));
+  fs::path report_path = input_path;
+  report_path += ".txt";
+  if (!WriteFile(input_path, input) || !WriteFile(report_path, report)) {
+    LOG(ERROR) << "Cannot write artifact " << input_path;
+    return "";
+  }
+  return input_path.string();
+}
+
+}  // namespace spanner_emulator_fuzzer
@@ -0,0 +1,35 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_ARTIFACTS_H
+#define SRC_FUZZ_UTILS_ARTIFACTS_H
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+
+namespace spanner_emulator_fuzzer {
+
+// Writes a finding to <dir>/<kind>-<hash of input>, where the input can be
+// fed straight back to the fuzz target, plus a human readable report next to
+// it with a .txt suffix. Returns the path of the saved input, or an empty
+// string if it could not be written.
+std::string SaveArtifact(absl::string_view dir, absl::string_view kind,
+                         absl::string_view input, absl::string_view report);
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_ARTIFACTS_H
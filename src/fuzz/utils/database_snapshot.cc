@@ -0,0 +1,157 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/database_snapshot.h"
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "google/cloud/optional.h"
+#include "google/cloud/spanner/keys.h"
+#include "google/cloud/spanner/mutations.h"
+#include "google/cloud/spanner/row.h"
+
+namespace spanner_emulator_fuzzer {
+
+namespace {
+
+namespace spanner = ::google::cloud::spanner;
+using ::google::cloud::Status;
+using ::google::cloud::StatusOr;
+
+// Rows per commit when cloning, well below the per-commit mutation limit for
+// tables of a few dozen columns.
+constexpr std::size_t kCloneBatchSize = 500;
+
+// Returns the user tables of the database, parents before their children.
+StatusOr<std::vector<DatabaseSnapshot::Table>> ReadTables(
+    spanner::Client& client) {
+  std::map<std::string, std::string> parents;
+  auto table_rows = client.ExecuteQuery(spanner::SqlStatement(
+      "SELECT TABLE_NAME, PARENT_TABLE_NAME FROM INFORMATION_SCHEMA.TABLES "
+      "WHERE TABLE_SCHEMA = ''"));
+  for (auto const& row :
+       spanner::StreamOf<std::tuple<std::string,
+                                    google::cloud::optional<std::string>>>(
+           table_rows)) {
+    if (!row) return row.status();
+    parents[std::get<0>(*row)] = std::get<1>(*row).value_or("");
+  }
+
+  std::map<std::string, std::vector<std::string>> columns;
+  auto column_rows = client.ExecuteQuery(spanner::SqlStatement(
+      "SELECT TABLE_NAME, COLUMN_NAME FROM INFORMATION_SCHEMA.COLUMNS "
+      "WHERE TABLE_SCHEMA = '' ORDER BY TABLE_NAME, ORDINAL_POSITION"));
+  for (auto const& row :
+       spanner::StreamOf<std::tuple<std::string, std::string>>(column_rows)) {
+    if (!row) return row.status();
+    columns[std::get<0>(*row)].push_back(std::get<1>(*row));
+  }
+
+  std::function<int(const std::string&)> depth =
+      [&](const std::string& table) -> int {
+    auto parent = parents.find(table);
+    if (parent == parents.end() || parent->second.empty()) return 0;
+    return depth(parent->second) + 1;
+  };
+  std::multimap<int, DatabaseSnapshot::Table> by_depth;
+  for (const auto& table : parents) {
+    by_depth.emplace(depth(table.first),
+                     DatabaseSnapshot::Table{table.first, columns[table.first]});
+  }
+
+  std::vector<DatabaseSnapshot::Table> tables;
+  for (auto& entry : by_depth) {
+    tables.push_back(std::move(entry.second));
+  }
+  return tables;
+}
+
+}  // namespace
+
+DatabaseSnapshot::DatabaseSnapshot(EmulatorHarness* harness,
+                                   spanner::Database database,
+                                   std::vector<std::string> schema,
+                                   std::vector<Table> tables)
+    : harness_(harness),
+      database_(std::move(database)),
+      client_(harness->MakeClient(database_)),
+      schema_(std::move(schema)),
+      tables_(std::move(tables)) {}
+
+StatusOr<DatabaseSnapshot> DatabaseSnapshot::Capture(
+    EmulatorHarness* harness, const spanner::Database& database) {
+  auto ddl = harness->admin_client().GetDatabaseDdl(database);
+  if (!ddl) return ddl.status();
+  std::vector<std::string> schema(ddl->statements().begin(),
+                                  ddl->statements().end());
+
+  spanner::Client client = harness->MakeClient(database);
+  auto tables = ReadTables(client);
+  if (!tables) return tables.status();
+
+  return DatabaseSnapshot(harness, database, std::move(schema),
+                          *std::move(tables));
+}
+
+Status DatabaseSnapshot::RunIsolated(
+    const std::function<Status(spanner::Client&, spanner::Transaction)>& fn) {
+  spanner::Transaction transaction = spanner::MakeReadWriteTransaction();
+  Status status = fn(client_, transaction);
+  // Rolling back discards the input's writes. A transaction that never
+  // executed a statement has nothing to roll back, which is not an error.
+  client_.Rollback(transaction);
+  return status;
+}
+
+StatusOr<spanner::Database> DatabaseSnapshot::Clone() {
+  spanner::Database clone = harness_->NewDatabase();
+  Status status = harness_->CreateDatabase(clone, schema_);
+  if (!status.ok()) return status;
+
+  spanner::Client clone_client = harness_->MakeClient(clone);
+  for (const Table& table : tables_) {
+    auto rows = client_.Read(table.name, spanner::KeySet::All(), table.columns);
+    spanner::Mutations batch;
+    auto flush = [&]() -> Status {
+      if (batch.empty()) return Status();
+      auto commit = clone_client.Commit(std::move(batch));
+      batch.clear();
+      return commit.status();
+    };
+    for (auto const& row : rows) {
+      if (!row) return row.status();
+      batch.push_back(
+          spanner::InsertMutationBuilder(table.name, table.columns)
+              .AddRow(row->values())
+              .Build());
+      if (batch.size() >= kCloneBatchSize) {
+        status = flush();
+        if (!status.ok()) return status;
+      }
+    }
+    status = flush();
+    if (!status.ok()) return status;
+  }
+  return clone;
+}
+
+}  // namespace spanner_emulator_fuzzer
@@ -0,0 +1,90 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_DATABASE_SNAPSHOT_H
+#define SRC_FUZZ_UTILS_DATABASE_SNAPSHOT_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/database.h"
+#include "google/cloud/spanner/transaction.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include "src/fuzz/utils/emulator_harness.h"
+
+namespace spanner_emulator_fuzzer {
+
+// A seeded database that every input of a stateful fuzz target starts from.
+//
+// Reloading the seed rows through Commit for every input dominates runtime,
+// so instead the seeded database is captured once and then left untouched:
+//
+//  - RunIsolated hands each input a read-write transaction over the seeded
+//    data and rolls it back afterwards. Nothing the input writes reaches
+//    storage, so the reset costs time proportional to the input's changes,
+//    not to the size of the database.
+//  - Clone copies schema and rows into a fresh database, for inputs that
+//    need one of their own, e.g. to change the schema. This is proportional
+//    to the data size and is the fallback, not the fast path.
+//
+// Once captured, the source database must only be written through
+// RunIsolated.
+class DatabaseSnapshot {
+ public:
+  // A table of the snapshot with its columns in declaration order.
+  struct Table {
+    std::string name;
+    std::vector<std::string> columns;
+  };
+
+  // Reads the schema and table layout of an already seeded database. harness
+  // must outlive the snapshot.
+  static google::cloud::StatusOr<DatabaseSnapshot> Capture(
+      EmulatorHarness* harness, const google::cloud::spanner::Database& database);
+
+  // Runs an input inside a read-write transaction over the snapshot, then
+  // rolls the transaction back. Returns the status of fn.
+  google::cloud::Status RunIsolated(
+      const std::function<google::cloud::Status(
+          google::cloud::spanner::Client&,
+          google::cloud::spanner::Transaction)>& fn);
+
+  // Creates a new database holding the snapshot's schema and rows.
+  google::cloud::StatusOr<google::cloud::spanner::Database> Clone();
+
+  const google::cloud::spanner::Database& database() const { return database_; }
+  const std::vector<std::string>& schema() const { return schema_; }
+  // Parents come before their interleaved children.
+  const std::vector<Table>& tables() const { return tables_; }
+
+ private:
+  DatabaseSnapshot(EmulatorHarness* harness,
+                   google::cloud::spanner::Database database,
+                   std::vector<std::string> schema, std::vector<Table> tables);
+
+  EmulatorHarness* harness_;
+  google::cloud::spanner::Database database_;
+  google::cloud::spanner::Client client_;
+  std::vector<std::string> schema_;
+  std::vector<Table> tables_;
+};
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_DATABASE_SNAPSHOT_H
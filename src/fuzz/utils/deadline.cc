@@ -0,0 +1,169 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/deadline.h"
+
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include "absl/synchronization/mutex.h"
+#include "zetasql/base/logging.h"
+
+namespace spanner_emulator_fuzzer {
+
+namespace {
+
+// Enough for the concurrent calls of the widest fuzz target, plus a few
+// that outlived their deadline and are still winding down.
+constexpr int kDeadlineWorkers = 16;
+
+// How often a call still waiting for a worker checks whether the pool can
+// make progress at all.
+constexpr absl::Duration kQueueCheckInterval = absl::Seconds(1);
+// How long every worker may be held by abandoned calls before the emulator is
+// taken to be hung. Well above the retry bound of the harness's clients.
+constexpr absl::Duration kExhaustedLimit = absl::Minutes(1);
+
+// One call of RunWithDeadline, shared by the caller and the worker running it.
+struct Call {
+  explicit Call(std::function<google::cloud::Status()> fn)
+      : fn(std::move(fn)) {}
+
+  std::function<google::cloud::Status()> fn;
+  absl::Mutex mu;
+  bool started ABSL_GUARDED_BY(mu) = false;
+  bool done ABSL_GUARDED_BY(mu) = false;
+  // Set by the caller once the deadline passed. The worker stays busy until
+  // the call returns.
+  bool abandoned ABSL_GUARDED_BY(mu) = false;
+  google::cloud::Status status ABSL_GUARDED_BY(mu);
+};
+
+// Long-lived threads running the calls of RunWithDeadline. A call that misses
+// its deadline keeps its worker until the client's own retry policy gives up,
+// so abandoned calls can never add up to more than kDeadlineWorkers threads.
+class DeadlineWorkers {
+ public:
+  explicit DeadlineWorkers(int threads) : threads_(threads) {
+    for (int i = 0; i < threads; ++i) {
+      std::thread([this] { Work(); }).detach();
+    }
+  }
+
+  void Schedule(std::shared_ptr<Call> call) {
+    absl::MutexLock lock(&mu_);
+    queue_.push_back(std::move(call));
+  }
+
+  // Counts a call that missed its deadline and still holds its worker.
+  void Abandon() {
+    absl::MutexLock lock(&mu_);
+    ++abandoned_;
+    if (abandoned_ > threads_ / 2) {
+      LOG(WARNING) << abandoned_ << " of " << threads_
+                   << " deadline workers are held by abandoned calls";
+    }
+  }
+
+  // Whether queued calls can never run, since every worker is stuck in a
+  // call whose caller already gave up on it.
+  bool Exhausted() {
+    absl::MutexLock lock(&mu_);
+    return abandoned_ >= threads_;
+  }
+
+ private:
+  void Work() {
+    while (true) {
+      std::shared_ptr<Call> call;
+      {
+        absl::MutexLock lock(&mu_);
+        mu_.Await(absl::Condition(
+            +[](std::deque<std::shared_ptr<Call>>* queue) {
+              return !queue->empty();
+            },
+            &queue_));
+        call = std::move(queue_.front());
+        queue_.pop_front();
+      }
+      {
+        absl::MutexLock lock(&call->mu);
+        call->started = true;
+      }
+      google::cloud::Status status = call->fn();
+      absl::MutexLock lock(&call->mu);
+      call->status = std::move(status);
+      call->done = true;
+      if (call->abandoned) {
+        absl::MutexLock pool_lock(&mu_);
+        --abandoned_;
+      }
+    }
+  }
+
+  const int threads_;
+  absl::Mutex mu_;
+  std::deque<std::shared_ptr<Call>> queue_ ABSL_GUARDED_BY(mu_);
+  int abandoned_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// Never destroyed: a worker may still be inside an abandoned call at exit.
+DeadlineWorkers& Workers() {
+  static DeadlineWorkers* workers = new DeadlineWorkers(kDeadlineWorkers);
+  return *workers;
+}
+
+}  // namespace
+
+google::cloud::Status RunWithDeadline(std::function<google::cloud::Status()> call,
+                                      absl::Duration deadline) {
+  auto state = std::make_shared<Call>(std::move(call));
+  DeadlineWorkers& workers = Workers();
+  workers.Schedule(state);
+
+  absl::MutexLock lock(&state->mu);
+  // Time spent waiting for a worker does not count against the deadline.
+  absl::Duration exhausted;
+  while (!state->mu.AwaitWithTimeout(absl::Condition(&state->started),
+                                     kQueueCheckInterval)) {
+    if (!workers.Exhausted()) {
+      exhausted = absl::ZeroDuration();
+      continue;
+    }
+    exhausted += kQueueCheckInterval;
+    if (exhausted >= kExhaustedLimit) {
+      LOG(ERROR) << "All " << kDeadlineWorkers << " deadline workers have "
+                 << "been stuck in calls that missed their deadline for "
+                 << absl::FormatDuration(exhausted)
+                 << ", so no further call can run";
+      std::abort();
+    }
+  }
+  if (!state->mu.AwaitWithTimeout(absl::Condition(&state->done), deadline)) {
+    state->abandoned = true;
+    workers.Abandon();
+    return google::cloud::Status(
+        google::cloud::StatusCode::kDeadlineExceeded,
+        absl::StrCat("Call did not finish within ",
+                     absl::FormatDuration(deadline)));
+  }
+  return state->status;
+}
+
+}  // namespace spanner_emulator_fuzzer
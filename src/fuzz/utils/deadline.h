@@ -0,0 +1,63 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_DEADLINE_H
+#define SRC_FUZZ_UTILS_DEADLINE_H
+
+#include <chrono>
+#include <functional>
+#include <future>
+
+#include "google/cloud/future.h"
+#include "google/cloud/status.h"
+#include "google/cloud/status_or.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+
+namespace spanner_emulator_fuzzer {
+
+// Waits at most deadline for an RPC future. On timeout the RPC is cancelled
+// and DEADLINE_EXCEEDED is returned instead of parking the fuzz worker.
+template <typename T>
+google::cloud::StatusOr<T> GetWithDeadline(
+    google::cloud::future<google::cloud::StatusOr<T>> result,
+    absl::Duration deadline) {
+  if (result.wait_for(absl::ToChronoMilliseconds(deadline)) ==
+      std::future_status::timeout) {
+    result.cancel();
+    return google::cloud::Status(
+        google::cloud::StatusCode::kDeadlineExceeded,
+        absl::StrCat("RPC did not finish within ",
+                     absl::FormatDuration(deadline)));
+  }
+  return result.get();
+}
+
+// Runs a blocking call, such as draining an ExecuteQuery stream, on a small
+// pool of long-lived worker threads and waits at most deadline for it. On
+// timeout DEADLINE_EXCEEDED is returned while the call keeps its worker until
+// it finishes, which the retry policy of clients from
+// EmulatorHarness::MakeClient bounds. call must own everything it touches.
+// Calls are queued while every worker is busy, and deadline only starts once
+// a worker picks the call up. If every worker stays held by calls that missed
+// their deadline for a minute, the emulator is taken to be hung and the
+// process aborts rather than failing every later call.
+google::cloud::Status RunWithDeadline(std::function<google::cloud::Status()> call,
+                                      absl::Duration deadline);
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_DEADLINE_H
@@ -0,0 +1,100 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/embedded_zoneinfo.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/internal/cctz/include/cctz/zone_info_source.h"
+
+namespace spanner_emulator_fuzzer {
+
+namespace {
+
+using ::absl::time_internal::cctz::ZoneInfoSource;
+
+// Reads one embedded TZif file, like the fallback factory's FILE*-backed
+// source reads one from disk.
+class EmbeddedZoneInfoSource : public ZoneInfoSource {
+ public:
+  explicit EmbeddedZoneInfoSource(const EmbeddedZone& zone)
+      : data_(zone.data), remaining_(zone.size) {}
+
+  std::size_t Read(void* ptr, std::size_t size) override {
+    size = std::min(size, remaining_);
+    std::memcpy(ptr, data_, size);
+    data_ += size;
+    remaining_ -= size;
+    return size;
+  }
+
+  int Skip(std::size_t offset) override {
+    if (offset > remaining_) return -1;
+    data_ += offset;
+    remaining_ -= offset;
+    return 0;
+  }
+
+  std::string Version() const override { return kEmbeddedZoneInfoVersion; }
+
+ private:
+  const char* data_;
+  std::size_t remaining_;
+};
+
+std::unique_ptr<ZoneInfoSource> EmbeddedZoneInfoFactory(
+    const std::string& name,
+    const std::function<std::unique_ptr<ZoneInfoSource>(const std::string&)>&
+        fallback_factory) {
+  if (const EmbeddedZone* zone = FindEmbeddedZone(name)) {
+    return std::make_unique<EmbeddedZoneInfoSource>(*zone);
+  }
+  return fallback_factory(name);
+}
+
+}  // namespace
+
+const EmbeddedZone* FindEmbeddedZone(absl::string_view name) {
+  const EmbeddedZone* end = kEmbeddedZones + kNumEmbeddedZones;
+  const EmbeddedZone* zone = std::lower_bound(
+      kEmbeddedZones, end, name,
+      [](const EmbeddedZone& zone, absl::string_view name) {
+        return absl::string_view(zone.name) < name;
+      });
+  if (zone == end || absl::string_view(zone->name) != name) return nullptr;
+  return zone;
+}
+
+}  // namespace spanner_emulator_fuzzer
+
+// Overrides the weak definition in absl, see zone_info_source.h.
+namespace absl {
+ABSL_NAMESPACE_BEGIN
+namespace time_internal {
+namespace cctz_extension {
+
+ZoneInfoSourceFactory zone_info_source_factory =
+    spanner_emulator_fuzzer::EmbeddedZoneInfoFactory;
+
+}  // namespace cctz_extension
+}  // namespace time_internal
+ABSL_NAMESPACE_END
+}  // namespace absl
@@ -0,0 +1,49 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_EMBEDDED_ZONEINFO_H
+#define SRC_FUZZ_UTILS_EMBEDDED_ZONEINFO_H
+
+#include <cstddef>
+
+#include "absl/strings/string_view.h"
+
+namespace spanner_emulator_fuzzer {
+
+// Time zone data compiled into the binary with --config=embedded_zoneinfo.
+// Linking the embedded_zoneinfo library registers it with absl's time zone
+// loader, which then reads zones from memory instead of from ${TZDIR}. Zones
+// missing from the table, and "localtime", still come from the filesystem.
+struct EmbeddedZone {
+  // Relative to the zoneinfo root, e.g. "America/Los_Angeles".
+  const char* name;
+  // The zone's TZif file.
+  const char* data;
+  std::size_t size;
+};
+
+// Sorted by name. Defined by the file embed_zoneinfo.py generates.
+extern const EmbeddedZone kEmbeddedZones[];
+extern const std::size_t kNumEmbeddedZones;
+// The tzdata release, e.g. "2020a", empty if it is unknown.
+extern const char kEmbeddedZoneInfoVersion[];
+
+// Returns the embedded zone of that name, or nullptr.
+const EmbeddedZone* FindEmbeddedZone(absl::string_view name);
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_EMBEDDED_ZONEINFO_H
@@ -0,0 +1,315 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/emulator_harness.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "zetasql/base/logging.h"
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/create_instance_request_builder.h"
+#include "google/cloud/spanner/instance_admin_client.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "src/fuzz/utils/deadline.h"
+#include "src/fuzz/utils/harness_config.h"
+#include "src/fuzz/utils/traffic_capture.h"
+
+namespace spanner_emulator_fuzzer {
+
+namespace {
+
+namespace spanner = ::google::cloud::spanner;
+using ::google::cloud::Status;
+using ::google::cloud::StatusOr;
+using ::google::spanner::emulator::frontend::Server;
+
+// A schema touching every column type, interleaving and a secondary index.
+const char* const kWarmUpSchema[] = {
+    R"sdl(
+      CREATE TABLE Singers (
+          SingerId   INT64 NOT NULL,
+          FirstName  STRING(1024),
+          LastName   STRING(1024),
+          SingerInfo BYTES(MAX),
+          Genres     ARRAY<STRING(MAX)>,
+          Rating     FLOAT64,
+          Active     BOOL,
+          BirthDate  DATE,
+          LastUpdate TIMESTAMP OPTIONS (allow_commit_timestamp = true)
+      ) PRIMARY KEY (SingerId))sdl",
+    R"sdl(
+      CREATE TABLE Albums (
+          SingerId     INT64 NOT NULL,
+          AlbumId      INT64 NOT NULL,
+          AlbumTitle   STRING(MAX)
+      ) PRIMARY KEY (SingerId, AlbumId),
+          INTERLEAVE IN PARENT Singers ON DELETE CASCADE)sdl",
+    R"sdl(CREATE INDEX AlbumsByTitle ON Albums(AlbumTitle))sdl",
+};
+
+// Queries that pull in the function families and analyzer paths the fuzz
+// inputs reach: arithmetic, strings and bytes, dates, timestamps with time
+// zones, arrays, joins, aggregation and index hints.
+const char* const kWarmUpQueries[] = {
+    "SELECT 'Hello World'",
+    "SELECT 1 + 2 * 3, 2.5 / 0.5, MOD(7, 3), ABS(-1), CAST('1' AS INT64)",
+    "SELECT CONCAT('a', 'b'), UPPER('x'), SUBSTR('abc', 2), LENGTH(b'bytes')",
+    "SELECT DATE_ADD(DATE '2020-01-01', INTERVAL 1 DAY), "
+    "TIMESTAMP_TRUNC(TIMESTAMP '2020-01-01 00:00:00+00', DAY, "
+    "'America/Los_Angeles')",
+    "SELECT ARRAY_LENGTH([1, 2, 3]), x FROM UNNEST([1, 2, 3]) AS x",
+    "SELECT s.SingerId, COUNT(a.AlbumId) FROM Singers s "
+    "LEFT JOIN Albums a ON s.SingerId = a.SingerId GROUP BY s.SingerId",
+    "SELECT AlbumTitle FROM Albums@{FORCE_INDEX=AlbumsByTitle} "
+    "WHERE AlbumTitle = 'warm-up'",
+};
+
+Status DrainQuery(spanner::Client& client, const std::string& sql) {
+  auto rows = client.ExecuteQuery(spanner::SqlStatement(sql));
+  for (auto const& row : rows) {
+    if (!row) return row.status();
+  }
+  return Status();
+}
+
+}  // namespace
+
+EmulatorHarness::EmulatorHarness(std::unique_ptr<Server> server,
+                                 spanner::v0::ConnectionOptions connection_options,
+                                 absl::Duration rpc_deadline)
+    : server_(std::move(server)),
+      connection_options_(std::move(connection_options)),
+      instance_("emulator", "emulator"),
+      rpc_deadline_(rpc_deadline),
+      admin_client_(spanner::MakeDatabaseAdminConnection(connection_options_)) {}
+
+EmulatorHarness::~EmulatorHarness() {
+  server_->Shutdown();
+}
+
+std::unique_ptr<EmulatorHarness> EmulatorHarness::Create(
+    const Options& options) {
+  absl::Time start = absl::Now();
+  Server::Options server_options;
+  server_options.server_address = options.server_address;
+  std::unique_ptr<Server> server = Server::Create(server_options);
+  if (!server) {
+    LOG(ERROR) << "Cannot start the emulator on " << options.server_address;
+    return nullptr;
+  }
+
+  // Capture has to be in place before the client creates its channels.
+  if (!options.capture_file.empty()) {
+    StartTrafficCapture(options.capture_file);
+  }
+
+  // This is the connection to the emulator.
+  spanner::v0::ConnectionOptions connection_options;
+  connection_options.set_endpoint(options.server_address)
+      .set_credentials(grpc::InsecureChannelCredentials());
+
+  std::unique_ptr<EmulatorHarness> harness(
+      new EmulatorHarness(std::move(server), std::move(connection_options),
+                          options.rpc_deadline));
+  Status status = harness->CreateInstance();
+  if (!status.ok()) {
+    LOG(ERROR) << "Cannot create the emulator instance: " << status.message();
+    return nullptr;
+  }
+  harness->startup_duration_ = absl::Now() - start;
+
+  if (options.warm_up) {
+    start = absl::Now();
+    status = harness->WarmUp();
+    harness->warm_up_duration_ = absl::Now() - start;
+    if (!status.ok()) {
+      LOG(WARNING) << "Warm-up did not complete: " << status.message();
+    }
+  }
+  return harness;
+}
+
+EmulatorHarness* EmulatorHarness::Default() {
+  static EmulatorHarness* harness = [] {
+    Options options;
+    options.warm_up = GetHarnessConfig().warm_up;
+    options.rpc_deadline = GetHarnessConfig().rpc_deadline;
+    options.capture_file = GetHarnessConfig().capture_file;
+    EmulatorHarness* harness = Create(options).release();
+    if (harness != nullptr) {
+      harness->ReportStats();
+      std::atexit([] { Default()->ReportStats(); });
+    }
+    return harness;
+  }();
+  return harness;
+}
+
+Status EmulatorHarness::CreateInstance() {
+  spanner::InstanceAdminClient instance_client(
+      spanner::MakeInstanceAdminConnection(connection_options_));
+  auto instance_or = GetWithDeadline(
+      instance_client.CreateInstance(
+          spanner::CreateInstanceRequestBuilder(instance_, "emulator")
+              .SetDisplayName("emulator")
+              .SetNodeCount(1)
+              .SetLabels({{"label-key", "label-value"}})
+              .Build()),
+      rpc_deadline_);
+  if (!instance_or) return instance_or.status();
+  LOG(INFO) << "Created instance [" << instance_ << "]";
+  return Status();
+}
+
+spanner::Client EmulatorHarness::MakeClient(
+    const spanner::Database& database) const {
+  auto deadline = absl::ToChronoMilliseconds(rpc_deadline_);
+  return spanner::Client(spanner::MakeConnection(
+      database, connection_options_, spanner::SessionPoolOptions(),
+      spanner::LimitedTimeRetryPolicy(deadline).clone(),
+      spanner::ExponentialBackoffPolicy(std::chrono::milliseconds(10),
+                                        deadline, 2.0)
+          .clone()));
+}
+
+spanner::Database EmulatorHarness::NewDatabase() {
+  return spanner::Database(instance_,
+                           absl::StrCat("fuzz-db-", next_database_id_++));
+}
+
+Status EmulatorHarness::CreateDatabase(
+    const spanner::Database& database,
+    const std::vector<std::string>& statements) {
+  auto db_or = GetWithDeadline(
+      admin_client_.CreateDatabase(database, statements), rpc_deadline_);
+  return db_or.status();
+}
+
+Status EmulatorHarness::UpdateDatabase(
+    const spanner::Database& database,
+    const std::vector<std::string>& statements) {
+  auto metadata_or = GetWithDeadline(
+      admin_client_.UpdateDatabase(database, statements), rpc_deadline_);
+  return metadata_or.status();
+}
+
+Status EmulatorHarness::DropDatabase(const spanner::Database& database) {
+  // DropDatabase is a unary call without a future, so bound it on a worker.
+  spanner::DatabaseAdminClient admin_client = admin_client_;
+  return RunWithDeadline(
+      [admin_client, database]() mutable {
+        return admin_client.DropDatabase(database);
+      },
+      rpc_deadline_);
+}
+
+Status EmulatorHarness::WarmUp() {
+  auto timed = [this](const std::string& name, const auto& step) {
+    absl::Time start = absl::Now();
+    Status status = step();
+    warm_up_latencies_.emplace_back(name, absl::Now() - start);
+    return status;
+  };
+
+  spanner::Database database = NewDatabase();
+  Status status = timed("create_database", [&] {
+    return CreateDatabase(database, std::vector<std::string>(
+                                        std::begin(kWarmUpSchema),
+                                        std::end(kWarmUpSchema)));
+  });
+  if (!status.ok()) return status;
+
+  spanner::Client client = MakeClient(database);
+  status = timed("dml_commit", [&] {
+    return client.Commit([&client](spanner::Transaction txn)
+                             -> StatusOr<spanner::Mutations> {
+      auto dml = client.ExecuteDml(
+          std::move(txn),
+          spanner::SqlStatement("INSERT INTO Singers (SingerId, FirstName) "
+                                "VALUES (1, 'warm-up')"));
+      if (!dml) return dml.status();
+      return spanner::Mutations{};
+    }).status();
+  });
+  if (!status.ok()) return status;
+
+  status = timed("mutation_commit", [&] {
+    return client.Commit(spanner::Mutations{
+        spanner::InsertOrUpdateMutationBuilder(
+            "Albums", {"SingerId", "AlbumId", "AlbumTitle"})
+            .EmplaceRow(std::int64_t{1}, std::int64_t{1},
+                        std::string("warm-up"))
+            .Build()}).status();
+  });
+  if (!status.ok()) return status;
+
+  status = timed("read", [&] {
+    auto rows = client.Read("Singers", spanner::KeySet::All(),
+                            {"SingerId", "FirstName"});
+    for (auto const& row : rows) {
+      if (!row) return row.status();
+    }
+    return Status();
+  });
+  if (!status.ok()) return status;
+
+  for (const char* query : kWarmUpQueries) {
+    status = timed(query, [&] { return DrainQuery(client, query); });
+    if (!status.ok()) return status;
+  }
+
+  return timed("drop_database", [&] { return DropDatabase(database); });
+}
+
+void EmulatorHarness::RecordInput(absl::Duration latency) {
+  steady_state_latency_.Record(latency);
+  int64_t inputs = ++inputs_recorded_;
+  int interval = GetHarnessConfig().report_interval_inputs;
+  if (interval > 0 && inputs % interval == 0) {
+    ReportStats();
+  }
+}
+
+void EmulatorHarness::AddReportSection(
+    std::string name, std::function<std::string()> section) {
+  report_sections_.emplace_back(std::move(name), std::move(section));
+}
+
+void EmulatorHarness::ReportStats() const {
+  std::string report = absl::StrCat(
+      "Emulator statistics\n",
+      "  startup (server + instance): ", absl::FormatDuration(startup_duration_),
+      "\n  warm-up: ", absl::FormatDuration(warm_up_duration_), "\n");
+  for (const auto& step : warm_up_latencies_) {
+    absl::StrAppend(&report, "    ", absl::FormatDuration(step.second), "  ",
+                    step.first, "\n");
+  }
+  absl::StrAppend(&report, "  steady state per input: ",
+                  steady_state_latency_.Summary());
+  for (const auto& section : report_sections_) {
+    absl::StrAppend(&report, "\n  ", section.first, ": ", section.second());
+  }
+  LOG(INFO) << report;
+}
+
+}  // namespace spanner_emulator_fuzzer
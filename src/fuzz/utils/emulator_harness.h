@@ -0,0 +1,148 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_EMULATOR_HARNESS_H
+#define SRC_FUZZ_UTILS_EMULATOR_HARNESS_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "frontend/server/server.h"
+#include "google/cloud/spanner/connection_options.h"
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/spanner/database.h"
+#include "google/cloud/spanner/database_admin_client.h"
+#include "google/cloud/spanner/instance.h"
+#include "google/cloud/status.h"
+#include "absl/time/time.h"
+#include "src/fuzz/utils/latency_stats.h"
+
+namespace spanner_emulator_fuzzer {
+
+// An in-process emulator with a ready instance, shared by every input of a
+// fuzz target or benchmark. Starting the server, creating the instance and
+// letting ZetaSQL build its function catalog and type singletons dominates the
+// cost of the first few statements, so this is done once and its cost is
+// reported separately from the steady-state latency of the inputs.
+class EmulatorHarness {
+ public:
+  struct Options {
+    std::string server_address = "localhost:1234";
+    // Run the warm-up workload before returning from Create.
+    bool warm_up = true;
+    // Longest a single RPC may take, see HarnessConfig::rpc_deadline.
+    absl::Duration rpc_deadline = absl::Seconds(10);
+    // Record the emulator traffic to this file, see StartTrafficCapture.
+    std::string capture_file;
+  };
+
+  // Starts the emulator and creates the shared instance. Returns nullptr if
+  // either step fails.
+  static std::unique_ptr<EmulatorHarness> Create(const Options& options);
+
+  // The process-wide harness used by the fuzz targets, configured from
+  // GetHarnessConfig() and created on first use. It is never destroyed and
+  // reports its statistics at exit. Returns nullptr if it could not be created.
+  static EmulatorHarness* Default();
+
+  ~EmulatorHarness();
+
+  EmulatorHarness(const EmulatorHarness&) = delete;
+  EmulatorHarness& operator=(const EmulatorHarness&) = delete;
+
+  const google::cloud::spanner::v0::ConnectionOptions& connection_options()
+      const {
+    return connection_options_;
+  }
+  const google::cloud::spanner::Instance& instance() const { return instance_; }
+  absl::Duration rpc_deadline() const { return rpc_deadline_; }
+  google::cloud::spanner::DatabaseAdminClient& admin_client() {
+    return admin_client_;
+  }
+
+  // Returns a client for database whose retries give up after rpc_deadline,
+  // instead of the client library's default of several minutes.
+  google::cloud::spanner::Client MakeClient(
+      const google::cloud::spanner::Database& database) const;
+
+  // Returns a database in the shared instance whose id has not been handed out
+  // before, so inputs never collide with the databases of earlier inputs.
+  google::cloud::spanner::Database NewDatabase();
+
+  // CreateDatabase, UpdateDatabase and DropDatabase all give up with
+  // DEADLINE_EXCEEDED after rpc_deadline.
+  google::cloud::Status CreateDatabase(
+      const google::cloud::spanner::Database& database,
+      const std::vector<std::string>& statements);
+  // Applies statements to the schema of an existing database, returning once
+  // the whole batch has been applied or the first statement failed.
+  google::cloud::Status UpdateDatabase(
+      const google::cloud::spanner::Database& database,
+      const std::vector<std::string>& statements);
+  google::cloud::Status DropDatabase(
+      const google::cloud::spanner::Database& database);
+
+  // Time taken to start the server and create the instance.
+  absl::Duration startup_duration() const { return startup_duration_; }
+  // Time taken by the warm-up workload, zero if it was skipped.
+  absl::Duration warm_up_duration() const { return warm_up_duration_; }
+
+  // Records the end-to-end latency of one input run after warm-up and logs
+  // ReportStats every report_interval_inputs inputs.
+  void RecordInput(absl::Duration latency);
+  const LatencyStats& steady_state_latency() const {
+    return steady_state_latency_;
+  }
+
+  // Adds a line to every report, e.g. for a fuzz target's cache statistics.
+  void AddReportSection(std::string name, std::function<std::string()> section);
+
+  // Logs startup, per-statement warm-up and steady-state latencies, followed
+  // by the added report sections.
+  void ReportStats() const;
+
+ private:
+  EmulatorHarness(
+      std::unique_ptr<google::spanner::emulator::frontend::Server> server,
+      google::cloud::spanner::v0::ConnectionOptions connection_options,
+      absl::Duration rpc_deadline);
+
+  google::cloud::Status CreateInstance();
+  google::cloud::Status WarmUp();
+
+  std::unique_ptr<google::spanner::emulator::frontend::Server> server_;
+  google::cloud::spanner::v0::ConnectionOptions connection_options_;
+  google::cloud::spanner::Instance instance_;
+  absl::Duration rpc_deadline_;
+  google::cloud::spanner::DatabaseAdminClient admin_client_;
+  std::atomic<int64_t> next_database_id_{0};
+
+  absl::Duration startup_duration_;
+  absl::Duration warm_up_duration_;
+  std::vector<std::pair<std::string, absl::Duration>> warm_up_latencies_;
+  LatencyStats steady_state_latency_;
+  std::atomic<int64_t> inputs_recorded_{0};
+  std::vector<std::pair<std::string, std::function<std::string()>>>
+      report_sections_;
+};
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_EMULATOR_HARNESS_H
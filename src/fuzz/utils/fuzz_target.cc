@@ -0,0 +1,91 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/fuzz_target.h"
+
+#include <string>
+#include <utility>
+
+#include "src/fuzz/utils/deadline.h"
+#include "src/fuzz/utils/harness_config.h"
+
+namespace spanner_emulator_fuzzer {
+
+namespace spanner = ::google::cloud::spanner;
+
+OutcomeFeatures* CreateOutcomeFeatures(EmulatorHarness* harness) {
+  auto* features = new OutcomeFeatures(GetHarnessConfig());
+  harness->AddReportSection("outcome features",
+                            [features] { return features->StatsString(); });
+  return features;
+}
+
+void RecordOutcome(OutcomeFeatures* features,
+                   const google::cloud::Status& status) {
+  if (status.code() != google::cloud::StatusCode::kDeadlineExceeded) {
+    features->Record(static_cast<int>(status.code()), status.message());
+  }
+}
+
+google::cloud::Status CommitDml(spanner::Client client, std::string sql,
+                                absl::Duration deadline) {
+  return RunWithDeadline(
+      [client, sql]() mutable {
+        return client
+            .Commit([&client, &sql](spanner::Transaction txn)
+                        -> google::cloud::StatusOr<spanner::Mutations> {
+              auto dml =
+                  client.ExecuteDml(std::move(txn), spanner::SqlStatement(sql));
+              if (!dml) return dml.status();
+              return spanner::Mutations{};
+            })
+            .status();
+      },
+      deadline);
+}
+
+InputRunner::InputRunner(EmulatorHarness* harness)
+    : harness_(harness),
+      leak_detector_(GetHarnessConfig()),
+      slow_unit_reporter_(GetHarnessConfig()) {}
+
+int InputRunner::Run(absl::string_view input,
+                     const std::function<int(InputProfile*)>& run) {
+  InputProfile profile;
+  profile.Begin();
+  int result = run(&profile);
+  profile.End();
+  Check(profile, input);
+  return result;
+}
+
+int InputRunner::Run(const google::protobuf::Message& input,
+                     const std::function<int(InputProfile*)>& run) {
+  InputProfile profile;
+  profile.Begin();
+  int result = run(&profile);
+  profile.End();
+  Check(profile, input.DebugString());
+  return result;
+}
+
+void InputRunner::Check(const InputProfile& profile, absl::string_view input) {
+  harness_->RecordInput(profile.duration());
+  leak_detector_.Check(profile, input);
+  slow_unit_reporter_.Check(profile, input);
+}
+
+}  // namespace spanner_emulator_fuzzer
@@ -0,0 +1,76 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_FUZZ_TARGET_H
+#define SRC_FUZZ_UTILS_FUZZ_TARGET_H
+
+#include <functional>
+#include <string>
+
+#include "google/cloud/spanner/client.h"
+#include "google/cloud/status.h"
+#include "google/protobuf/message.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "src/fuzz/utils/emulator_harness.h"
+#include "src/fuzz/utils/input_profile.h"
+#include "src/fuzz/utils/leak_detector.h"
+#include "src/fuzz/utils/outcome_features.h"
+#include "src/fuzz/utils/slow_unit_reporter.h"
+
+namespace spanner_emulator_fuzzer {
+
+// Returns the extra coverage features fed from a target's results, printed as
+// the "outcome features" report section of harness.
+OutcomeFeatures* CreateOutcomeFeatures(EmulatorHarness* harness);
+
+// Records a result that depends on the input, leaving out timeouts, which
+// depend on the machine.
+void RecordOutcome(OutcomeFeatures* features,
+                   const google::cloud::Status& status);
+
+// Commits sql as DML in a read-write transaction, through RunWithDeadline.
+google::cloud::Status CommitDml(google::cloud::spanner::Client client,
+                                std::string sql, absl::Duration deadline);
+
+// The per-input bookkeeping every fuzz target shares: profiles the input,
+// records its latency with the harness and checks it for leaks and slowness.
+// Meant to be a function-local static of the fuzz entry point.
+class InputRunner {
+ public:
+  explicit InputRunner(EmulatorHarness* harness);
+
+  // Runs one input through run and returns its result. input is saved as
+  // the reproducer if the input leaks or is slow.
+  int Run(absl::string_view input,
+          const std::function<int(InputProfile*)>& run);
+
+  // Same for DEFINE_PROTO_FUZZER inputs, which are saved in text format,
+  // since that is what DEFINE_PROTO_FUZZER reads back.
+  int Run(const google::protobuf::Message& input,
+          const std::function<int(InputProfile*)>& run);
+
+ private:
+  void Check(const InputProfile& profile, absl::string_view input);
+
+  EmulatorHarness* harness_;
+  LeakDetector leak_detector_;
+  SlowUnitReporter slow_unit_reporter_;
+};
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_FUZZ_TARGET_H
@@ -0,0 +1,94 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/harness_config.h"
+
+#include <cstdlib>
+#include <string>
+
+#include "absl/strings/numbers.h"
+
+namespace spanner_emulator_fuzzer {
+
+namespace {
+
+std::string GetEnvString(const char* name, const std::string& default_value) {
+  const char* value = std::getenv(name);
+  return value == nullptr ? default_value : std::string(value);
+}
+
+int64_t GetEnvInt(const char* name, int64_t default_value) {
+  const char* value = std::getenv(name);
+  int64_t parsed;
+  if (value == nullptr || !absl::SimpleAtoi(value, &parsed)) {
+    return default_value;
+  }
+  return parsed;
+}
+
+bool GetEnvBool(const char* name, bool default_value) {
+  const char* value = std::getenv(name);
+  bool parsed;
+  if (value == nullptr || !absl::SimpleAtob(value, &parsed)) {
+    return default_value;
+  }
+  return parsed;
+}
+
+HarnessConfig ReadHarnessConfig() {
+  HarnessConfig config;
+  config.artifact_dir =
+      GetEnvString("SPANNER_FUZZ_ARTIFACT_DIR", config.artifact_dir);
+  config.leak_threshold_bytes =
+      GetEnvInt("SPANNER_FUZZ_LEAK_THRESHOLD_MB",
+                config.leak_threshold_bytes >> 20) << 20;
+  config.leak_warmup_inputs =
+      GetEnvInt("SPANNER_FUZZ_LEAK_WARMUP_INPUTS", config.leak_warmup_inputs);
+  config.abort_on_leak =
+      GetEnvBool("SPANNER_FUZZ_ABORT_ON_LEAK", config.abort_on_leak);
+  config.warm_up = GetEnvBool("SPANNER_FUZZ_WARM_UP", config.warm_up);
+  config.report_interval_inputs = GetEnvInt("SPANNER_FUZZ_REPORT_INTERVAL",
+                                            config.report_interval_inputs);
+  config.rpc_deadline = absl::Milliseconds(
+      GetEnvInt("SPANNER_FUZZ_RPC_DEADLINE_MS",
+                absl::ToInt64Milliseconds(config.rpc_deadline)));
+  config.slow_unit_budget = absl::Milliseconds(
+      GetEnvInt("SPANNER_FUZZ_SLOW_UNIT_MS",
+                absl::ToInt64Milliseconds(config.slow_unit_budget)));
+  config.slow_unit_dir =
+      GetEnvString("SPANNER_FUZZ_SLOW_UNIT_DIR", config.slow_unit_dir);
+  config.result_cache_entries = GetEnvInt("SPANNER_FUZZ_RESULT_CACHE_ENTRIES",
+                                          config.result_cache_entries);
+  config.result_cache_bytes =
+      GetEnvInt("SPANNER_FUZZ_RESULT_CACHE_MB",
+                config.result_cache_bytes >> 20) << 20;
+  config.invalid_sample_percent = GetEnvInt(
+      "SPANNER_FUZZ_INVALID_SAMPLE_PERCENT", config.invalid_sample_percent);
+  config.outcome_features =
+      GetEnvBool("SPANNER_FUZZ_OUTCOME_FEATURES", config.outcome_features);
+  config.capture_file =
+      GetEnvString("SPANNER_FUZZ_CAPTURE_FILE", config.capture_file);
+  return config;
+}
+
+}  // namespace
+
+const HarnessConfig& GetHarnessConfig() {
+  static const HarnessConfig* config = new HarnessConfig(ReadHarnessConfig());
+  return *config;
+}
+
+}  // namespace spanner_emulator_fuzzer
@@ -0,0 +1,97 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_HARNESS_CONFIG_H
+#define SRC_FUZZ_UTILS_HARNESS_CONFIG_H
+
+#include <cstdint>
+#include <string>
+
+#include "absl/time/time.h"
+
+namespace spanner_emulator_fuzzer {
+
+// Knobs shared by the fuzz harnesses. libFuzzer and AFL own the command line,
+// so every field is read from a SPANNER_FUZZ_* environment variable.
+struct HarnessConfig {
+  // Directory that leak and other findings are written to
+  // (SPANNER_FUZZ_ARTIFACT_DIR).
+  std::string artifact_dir = ".";
+
+  // Heap or RSS growth retained by a single input before it is reported as a
+  // leak (SPANNER_FUZZ_LEAK_THRESHOLD_MB).
+  int64_t leak_threshold_bytes = int64_t{64} << 20;
+
+  // Inputs executed before the leak gate arms, so one-time allocations such
+  // as lazily built catalogs and gRPC pools are not reported
+  // (SPANNER_FUZZ_LEAK_WARMUP_INPUTS).
+  int leak_warmup_inputs = 50;
+
+  // Abort on the first leak finding so the fuzzing engine records a crash
+  // (SPANNER_FUZZ_ABORT_ON_LEAK).
+  bool abort_on_leak = false;
+
+  // Run representative DDL and queries through the emulator before the first
+  // input, so per-process initialization is not charged to it
+  // (SPANNER_FUZZ_WARM_UP).
+  bool warm_up = true;
+
+  // Inputs between two periodic statistics reports. 0 only reports at exit
+  // (SPANNER_FUZZ_REPORT_INTERVAL).
+  int report_interval_inputs = 10000;
+
+  // Longest any single emulator RPC may take before the harness gives up on it
+  // with DEADLINE_EXCEEDED (SPANNER_FUZZ_RPC_DEADLINE_MS).
+  absl::Duration rpc_deadline = absl::Seconds(10);
+
+  // Inputs that take longer than this end to end are saved as slow units
+  // (SPANNER_FUZZ_SLOW_UNIT_MS). Zero disables the reporter.
+  absl::Duration slow_unit_budget = absl::Seconds(2);
+
+  // Directory slow units are written to, kept apart from crashes and leaks so
+  // it can be used as a corpus of performance bugs
+  // (SPANNER_FUZZ_SLOW_UNIT_DIR).
+  std::string slow_unit_dir = "slow_units";
+
+  // Rendered statements whose emulator result is remembered, so exact
+  // repeats skip the RPC. 0 disables the cache
+  // (SPANNER_FUZZ_RESULT_CACHE_ENTRIES).
+  int64_t result_cache_entries = 0;
+
+  // Memory the result cache may use (SPANNER_FUZZ_RESULT_CACHE_MB).
+  int64_t result_cache_bytes = int64_t{64} << 20;
+
+  // Percentage of the statements the local validator knows to be invalid
+  // that are still sent to the emulator, to catch wrong predictions. The rest
+  // only go through the emulator's DDL parser
+  // (SPANNER_FUZZ_INVALID_SAMPLE_PERCENT).
+  int64_t invalid_sample_percent = 1;
+
+  // Feed status codes and error categories of emulator calls to libFuzzer
+  // as extra coverage features (SPANNER_FUZZ_OUTCOME_FEATURES).
+  bool outcome_features = true;
+
+  // If set, every RPC the harness sends to the emulator is recorded here for
+  // traffic_replay (SPANNER_FUZZ_CAPTURE_FILE).
+  std::string capture_file;
+};
+
+// Returns the configuration, read from the environment on first use.
+const HarnessConfig& GetHarnessConfig();
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_HARNESS_CONFIG_H
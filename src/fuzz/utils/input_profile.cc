@@ -0,0 +1,155 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/input_profile.h"
+
+#include <malloc.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+
+// Provided by the sanitizer runtimes. Declared weak so the harness still links
+// in uninstrumented builds, where mallinfo is used instead.
+extern "C" size_t __sanitizer_get_current_allocated_bytes() __attribute__((weak));
+
+namespace spanner_emulator_fuzzer {
+
+namespace {
+
+int64_t ReadRssBytes() {
+  FILE* statm = std::fopen("/proc/self/statm", "r");
+  if (statm == nullptr) {
+    return 0;
+  }
+  long total_pages = 0;
+  long resident_pages = 0;
+  int matched = std::fscanf(statm, "%ld %ld", &total_pages, &resident_pages);
+  std::fclose(statm);
+  if (matched != 2) {
+    return 0;
+  }
+  return static_cast<int64_t>(resident_pages) * sysconf(_SC_PAGESIZE);
+}
+
+int64_t ReadHeapBytes() {
+  if (__sanitizer_get_current_allocated_bytes != nullptr) {
+    return __sanitizer_get_current_allocated_bytes();
+  }
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  return mallinfo2().uordblks;
+#else
+  // mallinfo's fields are ints and wrap above 2GiB, which is still good enough
+  // to spot per-input growth.
+  return static_cast<unsigned int>(mallinfo().uordblks);
+#endif
+}
+
+std::string MegabytesToString(int64_t bytes) {
+  return absl::StrFormat("%+.2fMB", bytes / (1024.0 * 1024.0));
+}
+
+}  // namespace
+
+MemoryUsage ReadMemoryUsage() {
+  MemoryUsage usage;
+  usage.rss_bytes = ReadRssBytes();
+  usage.heap_bytes = ReadHeapBytes();
+  return usage;
+}
+
+PeakRssSampler::PeakRssSampler(absl::Duration interval)
+    : interval_(interval) {
+  {
+    absl::MutexLock lock(&mu_);
+    Sample();
+  }
+  thread_ = std::thread([this] {
+    absl::MutexLock lock(&mu_);
+    while (!mu_.AwaitWithTimeout(absl::Condition(&stopping_), interval_)) {
+      Sample();
+    }
+  });
+}
+
+PeakRssSampler::~PeakRssSampler() { Stop(); }
+
+int64_t PeakRssSampler::Stop() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  absl::MutexLock lock(&mu_);
+  Sample();
+  return peak_bytes_;
+}
+
+void PeakRssSampler::Sample() {
+  peak_bytes_ = std::max(peak_bytes_, ReadRssBytes());
+}
+
+InputProfile::ScopedPhase::ScopedPhase(InputProfile* profile,
+                                       absl::string_view name)
+    : profile_(profile),
+      name_(name),
+      start_time_(absl::Now()),
+      start_usage_(ReadMemoryUsage()) {}
+
+InputProfile::ScopedPhase::~ScopedPhase() {
+  MemoryUsage end_usage = ReadMemoryUsage();
+  PhaseProfile phase;
+  phase.name = std::move(name_);
+  phase.duration = absl::Now() - start_time_;
+  phase.rss_delta_bytes = end_usage.rss_bytes - start_usage_.rss_bytes;
+  phase.heap_delta_bytes = end_usage.heap_bytes - start_usage_.heap_bytes;
+  profile_->phases_.push_back(std::move(phase));
+}
+
+void InputProfile::Begin() {
+  phases_.clear();
+  start_usage_ = ReadMemoryUsage();
+  start_time_ = absl::Now();
+}
+
+void InputProfile::End() {
+  end_time_ = absl::Now();
+  end_usage_ = ReadMemoryUsage();
+}
+
+std::string InputProfile::DebugString() const {
+  std::string out = absl::StrCat(
+      "input: ", absl::FormatDuration(duration()),
+      " rss ", MegabytesToString(rss_delta_bytes()),
+      " heap ", MegabytesToString(heap_delta_bytes()), "\n");
+  for (const PhaseProfile& phase : phases_) {
+    absl::StrAppend(&out, "  ", phase.name, ": ",
+                    absl::FormatDuration(phase.duration),
+                    " rss ", MegabytesToString(phase.rss_delta_bytes),
+                    " heap ", MegabytesToString(phase.heap_delta_bytes), "\n");
+  }
+  return out;
+}
+
+}  // namespace spanner_emulator_fuzzer
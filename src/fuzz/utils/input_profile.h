@@ -0,0 +1,133 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_INPUT_PROFILE_H
+#define SRC_FUZZ_UTILS_INPUT_PROFILE_H
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace spanner_emulator_fuzzer {
+
+// A point-in-time sample of the process' memory.
+struct MemoryUsage {
+  // Resident set size as reported by /proc/self/statm.
+  int64_t rss_bytes = 0;
+  // Bytes currently handed out by the allocator. Uses the sanitizer allocator
+  // when one is linked in, and mallinfo otherwise.
+  int64_t heap_bytes = 0;
+};
+
+MemoryUsage ReadMemoryUsage();
+
+// Measures the peak resident set size of a single input by sampling
+// /proc/self/statm on a background thread from construction until Stop().
+// Unlike resetting VmHWM through /proc/self/clear_refs, this leaves the
+// process-wide peak alone, which libFuzzer's -rss_limit_mb relies on. Peaks
+// shorter than interval may be missed.
+class PeakRssSampler {
+ public:
+  explicit PeakRssSampler(absl::Duration interval = absl::Milliseconds(1));
+  ~PeakRssSampler();
+
+  PeakRssSampler(const PeakRssSampler&) = delete;
+  PeakRssSampler& operator=(const PeakRssSampler&) = delete;
+
+  // Stops sampling and returns the highest RSS seen, or 0 if /proc is not
+  // available.
+  int64_t Stop();
+
+ private:
+  void Sample() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const absl::Duration interval_;
+  absl::Mutex mu_;
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+  int64_t peak_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+  std::thread thread_;
+};
+
+// Wall time and memory deltas of one named step of an input, such as
+// "create_database" or "execute_query".
+struct PhaseProfile {
+  std::string name;
+  absl::Duration duration;
+  int64_t rss_delta_bytes = 0;
+  int64_t heap_delta_bytes = 0;
+};
+
+// Records what a single fuzz input cost, overall and per phase.
+//
+//   InputProfile profile;
+//   profile.Begin();
+//   {
+//     InputProfile::ScopedPhase phase(&profile, "create_database");
+//     ...
+//   }
+//   profile.End();
+class InputProfile {
+ public:
+  // Samples the phase's start on construction and appends its profile to the
+  // owning InputProfile on destruction.
+  class ScopedPhase {
+   public:
+    ScopedPhase(InputProfile* profile, absl::string_view name);
+    ~ScopedPhase();
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+   private:
+    InputProfile* profile_;
+    std::string name_;
+    absl::Time start_time_;
+    MemoryUsage start_usage_;
+  };
+
+  void Begin();
+  void End();
+
+  const std::vector<PhaseProfile>& phases() const { return phases_; }
+  absl::Duration duration() const { return end_time_ - start_time_; }
+  int64_t rss_delta_bytes() const {
+    return end_usage_.rss_bytes - start_usage_.rss_bytes;
+  }
+  int64_t heap_delta_bytes() const {
+    return end_usage_.heap_bytes - start_usage_.heap_bytes;
+  }
+  const MemoryUsage& end_usage() const { return end_usage_; }
+
+  // One line for the whole input followed by one line per phase.
+  std::string DebugString() const;
+
+ private:
+  absl::Time start_time_;
+  absl::Time end_time_;
+  MemoryUsage start_usage_;
+  MemoryUsage end_usage_;
+  std::vector<PhaseProfile> phases_;
+};
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_INPUT_PROFILE_H
@@ -0,0 +1,157 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/latency_stats.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+
+namespace spanner_emulator_fuzzer {
+
+LatencyStats::LatencyStats(const LatencyStats& other) { Merge(other); }
+
+LatencyStats& LatencyStats::operator=(const LatencyStats& other) {
+  if (this != &other) {
+    Clear();
+    Merge(other);
+  }
+  return *this;
+}
+
+int LatencyStats::BucketFor(int64_t nanos) {
+  if (nanos < (1 << kSubBucketBits)) {
+    return std::max<int64_t>(nanos, 0);
+  }
+  int exponent = 63 - __builtin_clzll(nanos);
+  int sub_bucket = (nanos >> (exponent - kSubBucketBits)) &
+                   ((1 << kSubBucketBits) - 1);
+  return ((exponent - kSubBucketBits + 1) << kSubBucketBits) + sub_bucket;
+}
+
+int64_t LatencyStats::BucketUpperBound(int bucket) {
+  if (bucket < (1 << kSubBucketBits)) {
+    return bucket;
+  }
+  int exponent = (bucket >> kSubBucketBits) + kSubBucketBits - 1;
+  int64_t sub_bucket = bucket & ((1 << kSubBucketBits) - 1);
+  int64_t lower = (int64_t{1} << exponent) +
+                  (sub_bucket << (exponent - kSubBucketBits));
+  return lower + (int64_t{1} << (exponent - kSubBucketBits)) - 1;
+}
+
+void LatencyStats::Record(absl::Duration latency) {
+  int64_t nanos = absl::ToInt64Nanoseconds(latency);
+  absl::MutexLock lock(&mu_);
+  ++buckets_[BucketFor(nanos)];
+  ++count_;
+  total_nanos_ += nanos;
+  max_nanos_ = std::max(max_nanos_, nanos);
+}
+
+void LatencyStats::Merge(const LatencyStats& other) {
+  // other is copied before mu_ is taken, never holding both locks, so that
+  // Merge(*this) and two histograms merged into each other do not deadlock.
+  std::array<int64_t, kNumBuckets> buckets;
+  int64_t count, total_nanos, max_nanos;
+  {
+    absl::MutexLock other_lock(&other.mu_);
+    buckets = other.buckets_;
+    count = other.count_;
+    total_nanos = other.total_nanos_;
+    max_nanos = other.max_nanos_;
+  }
+  absl::MutexLock lock(&mu_);
+  for (int i = 0; i < kNumBuckets; ++i) {
+    buckets_[i] += buckets[i];
+  }
+  count_ += count;
+  total_nanos_ += total_nanos;
+  max_nanos_ = std::max(max_nanos_, max_nanos);
+}
+
+void LatencyStats::Clear() {
+  absl::MutexLock lock(&mu_);
+  buckets_.fill(0);
+  count_ = 0;
+  total_nanos_ = 0;
+  max_nanos_ = 0;
+}
+
+LatencyStats LatencyStats::TakeAndClear() {
+  LatencyStats taken;
+  {
+    absl::MutexLock lock(&mu_);
+    absl::MutexLock taken_lock(&taken.mu_);
+    taken.buckets_ = buckets_;
+    taken.count_ = count_;
+    taken.total_nanos_ = total_nanos_;
+    taken.max_nanos_ = max_nanos_;
+    buckets_.fill(0);
+    count_ = 0;
+    total_nanos_ = 0;
+    max_nanos_ = 0;
+  }
+  return taken;
+}
+
+int64_t LatencyStats::count() const {
+  absl::MutexLock lock(&mu_);
+  return count_;
+}
+
+absl::Duration LatencyStats::Mean() const {
+  absl::MutexLock lock(&mu_);
+  return count_ == 0 ? absl::ZeroDuration()
+                     : absl::Nanoseconds(total_nanos_ / count_);
+}
+
+absl::Duration LatencyStats::Max() const {
+  absl::MutexLock lock(&mu_);
+  return absl::Nanoseconds(max_nanos_);
+}
+
+absl::Duration LatencyStats::Percentile(double percentile) const {
+  absl::MutexLock lock(&mu_);
+  if (count_ == 0) {
+    return absl::ZeroDuration();
+  }
+  int64_t rank = static_cast<int64_t>(percentile / 100.0 * count_ + 0.5);
+  rank = std::min(std::max<int64_t>(rank, 1), count_);
+  int64_t seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += buckets_[i];
+    if (seen >= rank) {
+      return absl::Nanoseconds(std::min(BucketUpperBound(i), max_nanos_));
+    }
+  }
+  return absl::Nanoseconds(max_nanos_);
+}
+
+std::string LatencyStats::Summary() const {
+  return absl::StrCat("n=", count(),
+                      " mean=", absl::FormatDuration(Mean()),
+                      " p50=", absl::FormatDuration(Percentile(50)),
+                      " p90=", absl::FormatDuration(Percentile(90)),
+                      " p99=", absl::FormatDuration(Percentile(99)),
+                      " p99.9=", absl::FormatDuration(Percentile(99.9)),
+                      " max=", absl::FormatDuration(Max()));
+}
+
+}  // namespace spanner_emulator_fuzzer
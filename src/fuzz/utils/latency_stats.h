@@ -0,0 +1,73 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_LATENCY_STATS_H
+#define SRC_FUZZ_UTILS_LATENCY_STATS_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace spanner_emulator_fuzzer {
+
+// A thread-safe latency histogram with constant memory, so it can run for the
+// whole lifetime of a fuzzing process. Buckets are log-linear: every power of
+// two is split into 8 sub-buckets, which bounds the error of a reported
+// percentile to 12.5%.
+class LatencyStats {
+ public:
+  LatencyStats() = default;
+  LatencyStats(const LatencyStats& other);
+  LatencyStats& operator=(const LatencyStats& other);
+
+  void Record(absl::Duration latency);
+  void Merge(const LatencyStats& other);
+  void Clear();
+  // Returns the latencies recorded so far and clears them atomically, so no
+  // concurrent Record is lost between reading an interval and starting the
+  // next one.
+  LatencyStats TakeAndClear();
+
+  int64_t count() const;
+  absl::Duration Mean() const;
+  absl::Duration Max() const;
+  // Returns the upper bound of the bucket holding the given percentile,
+  // where percentile is in [0, 100].
+  absl::Duration Percentile(double percentile) const;
+
+  // "n=... mean=... p50=... p90=... p99=... p99.9=... max=..."
+  std::string Summary() const;
+
+ private:
+  static constexpr int kSubBucketBits = 3;
+  static constexpr int kNumBuckets = 64 << kSubBucketBits;
+
+  static int BucketFor(int64_t nanos);
+  static int64_t BucketUpperBound(int bucket);
+
+  mutable absl::Mutex mu_;
+  std::array<int64_t, kNumBuckets> buckets_ ABSL_GUARDED_BY(mu_) = {};
+  int64_t count_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t total_nanos_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t max_nanos_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_LATENCY_STATS_H
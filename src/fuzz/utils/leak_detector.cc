@@ -0,0 +1,51 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/leak_detector.h"
+
+#include <cstdlib>
+#include <string>
+
+#include "zetasql/base/logging.h"
+#include "absl/strings/str_cat.h"
+#include "src/fuzz/utils/artifacts.h"
+
+namespace spanner_emulator_fuzzer {
+
+bool LeakDetector::Check(const InputProfile& profile, absl::string_view input) {
+  ++inputs_checked_;
+  if (inputs_checked_ <= config_.leak_warmup_inputs) {
+    return false;
+  }
+  if (profile.heap_delta_bytes() <= config_.leak_threshold_bytes &&
+      profile.rss_delta_bytes() <= config_.leak_threshold_bytes) {
+    return false;
+  }
+
+  ++leaks_found_;
+  std::string report = absl::StrCat(
+      "Input retained more than ", config_.leak_threshold_bytes >> 20,
+      "MB after it finished (input #", inputs_checked_, ", rss now ",
+      profile.end_usage().rss_bytes >> 20, "MB)\n", profile.DebugString());
+  std::string path = SaveArtifact(config_.artifact_dir, "leak", input, report);
+  LOG(ERROR) << "Memory leak finding saved to " << path << "\n" << report;
+  if (config_.abort_on_leak) {
+    std::abort();
+  }
+  return true;
+}
+
+}  // namespace spanner_emulator_fuzzer
@@ -0,0 +1,53 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_LEAK_DETECTOR_H
+#define SRC_FUZZ_UTILS_LEAK_DETECTOR_H
+
+#include "absl/strings/string_view.h"
+#include "src/fuzz/utils/harness_config.h"
+#include "src/fuzz/utils/input_profile.h"
+
+namespace spanner_emulator_fuzzer {
+
+// Turns steady memory growth into reproducible findings. Without it the
+// emulator's retained state pushes the process into libFuzzer's
+// -rss_limit_mb and the run dies with an out-of-memory report that does not
+// point at any input.
+//
+// An input leaks when, once it has finished and cleaned up after itself, the
+// process retains more than leak_threshold_bytes of extra heap or RSS. The
+// input is saved to artifact_dir as leak-<hash> together with its per-phase
+// profile.
+class LeakDetector {
+ public:
+  explicit LeakDetector(const HarnessConfig& config) : config_(config) {}
+
+  // Checks a finished input. Returns true if it was reported as a leak.
+  bool Check(const InputProfile& profile, absl::string_view input);
+
+  int inputs_checked() const { return inputs_checked_; }
+  int leaks_found() const { return leaks_found_; }
+
+ private:
+  const HarnessConfig& config_;
+  int inputs_checked_ = 0;
+  int leaks_found_ = 0;
+};
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_LEAK_DETECTOR_H
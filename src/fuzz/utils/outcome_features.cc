@@ -0,0 +1,107 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/outcome_features.h"
+
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_format.h"
+
+namespace spanner_emulator_fuzzer {
+
+namespace {
+
+// Read by libFuzzer after every input. Other engines ignore the section.
+#if defined(__linux__)
+__attribute__((section("__libfuzzer_extra_counters")))
+#endif
+uint8_t outcome_counters[OutcomeFeatures::kNumFeatures];
+
+// Long messages are mostly the echoed statement.
+constexpr size_t kMaxMessageLength = 512;
+constexpr int kMaxCategoryWords = 12;
+
+// FNV-1a, stable across processes so features mean the same in every run.
+uint64_t StableHash(absl::string_view data, uint64_t hash) {
+  for (unsigned char c : data) {
+    hash = (hash ^ c) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+bool IsCategoryWord(absl::string_view word) {
+  if (word.size() < 2) return false;
+  for (char c : word) {
+    if (!absl::ascii_islower(c) && c != '_') return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+std::string NormalizeErrorMessage(absl::string_view message) {
+  message = message.substr(0, kMaxMessageLength);
+  std::string category;
+  int words = 0;
+  char quote = 0;
+  size_t word_start = 0;
+  for (size_t i = 0; i <= message.size() && words < kMaxCategoryWords; ++i) {
+    char c = i < message.size() ? message[i] : ' ';
+    if (quote != 0) {
+      if (c == quote) quote = 0;
+      word_start = i + 1;
+      continue;
+    }
+    if (absl::ascii_isalnum(c) || c == '_') continue;
+
+    absl::string_view word = message.substr(word_start, i - word_start);
+    if (IsCategoryWord(word)) {
+      if (!category.empty()) category.push_back(' ');
+      category.append(word.data(), word.size());
+      ++words;
+    }
+    if (c == '"' || c == '\'' || c == '`') quote = c;
+    word_start = i + 1;
+  }
+  return category;
+}
+
+void OutcomeFeatures::Record(int status_code, absl::string_view message) {
+  if (!enabled_ || status_code < 0 ||
+      status_code >= static_cast<int>(kNumStatusCodes)) {
+    return;
+  }
+  ++recorded_;
+  outcome_counters[status_code] = 1;
+  seen_.set(status_code);
+  if (status_code == 0) return;
+
+  std::string category = NormalizeErrorMessage(message);
+  uint64_t hash = StableHash(category, 0xcbf29ce484222325ULL ^ status_code);
+  size_t feature = kNumStatusCodes + hash % kNumCategoryBuckets;
+  outcome_counters[feature] = 1;
+  seen_.set(feature);
+}
+
+std::string OutcomeFeatures::StatsString() const {
+  if (!enabled_) return "disabled";
+  return absl::StrFormat("%d outcomes recorded, %d distinct features",
+                         recorded_, seen_.count());
+}
+
+}  // namespace spanner_emulator_fuzzer
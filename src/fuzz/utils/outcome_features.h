@@ -0,0 +1,72 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_OUTCOME_FEATURES_H
+#define SRC_FUZZ_UTILS_OUTCOME_FEATURES_H
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "src/fuzz/utils/harness_config.h"
+
+namespace spanner_emulator_fuzzer {
+
+// Reports the outcome of an input's emulator calls to libFuzzer as extra
+// coverage features, through counters in the __libfuzzer_extra_counters
+// section. Inputs that run the same code but fail with a different status
+// code or a different kind of error message then count as new coverage and
+// are kept in the corpus. libFuzzer clears the counters before every input.
+//
+// Error messages are reduced to a category first: quoted text, numbers and
+// any word that is not plain lowercase or snake_case are dropped, since the
+// emulator echoes identifiers and parts of the statement back.
+class OutcomeFeatures {
+ public:
+  // One counter per status code, followed by the status code and error
+  // category pairs, hashed into buckets.
+  static constexpr size_t kNumStatusCodes = 17;
+  static constexpr size_t kNumCategoryBuckets = 4096;
+  static constexpr size_t kNumFeatures = kNumStatusCodes + kNumCategoryBuckets;
+
+  explicit OutcomeFeatures(const HarnessConfig& config)
+      : enabled_(config.outcome_features) {}
+
+  // Records the result of one call. status_code is a google::cloud::StatusCode
+  // and message is ignored for OK.
+  void Record(int status_code, absl::string_view message);
+
+  // Number of distinct features set so far, a coverage proxy to compare runs.
+  size_t features_seen() const { return seen_.count(); }
+
+  std::string StatsString() const;
+
+ private:
+  bool enabled_;
+  int64_t recorded_ = 0;
+  std::bitset<kNumFeatures> seen_;
+};
+
+// Returns the category of an emulator error message, e.g.
+// "Table Foo has a column named \"Bar\" at 1:25" becomes
+// "has column named at".
+std::string NormalizeErrorMessage(absl::string_view message);
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_OUTCOME_FEATURES_H
@@ -0,0 +1,46 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/slow_unit_reporter.h"
+
+#include <string>
+
+#include "zetasql/base/logging.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/time.h"
+#include "src/fuzz/utils/artifacts.h"
+
+namespace spanner_emulator_fuzzer {
+
+bool SlowUnitReporter::Check(const InputProfile& profile,
+                             absl::string_view input) {
+  if (config_.slow_unit_budget <= absl::ZeroDuration() ||
+      profile.duration() <= config_.slow_unit_budget) {
+    return false;
+  }
+
+  ++slow_units_found_;
+  std::string report = absl::StrCat(
+      "Input exceeded the latency budget of ",
+      absl::FormatDuration(config_.slow_unit_budget), " (RPC deadline ",
+      absl::FormatDuration(config_.rpc_deadline), ")\n", profile.DebugString());
+  std::string path =
+      SaveArtifact(config_.slow_unit_dir, "slow", input, report);
+  LOG(WARNING) << "Slow unit saved to " << path << "\n" << report;
+  return true;
+}
+
+}  // namespace spanner_emulator_fuzzer
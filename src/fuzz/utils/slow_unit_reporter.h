@@ -0,0 +1,47 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_SLOW_UNIT_REPORTER_H
+#define SRC_FUZZ_UTILS_SLOW_UNIT_REPORTER_H
+
+#include "absl/strings/string_view.h"
+#include "src/fuzz/utils/harness_config.h"
+#include "src/fuzz/utils/input_profile.h"
+
+namespace spanner_emulator_fuzzer {
+
+// Collects inputs that are correct but slow. Every input whose end-to-end
+// time exceeds slow_unit_budget is written to slow_unit_dir as slow-<hash>,
+// with its per-phase timings in the accompanying report, so pathological
+// schemas become a corpus of performance bugs instead of silently eating
+// fuzzing throughput.
+class SlowUnitReporter {
+ public:
+  explicit SlowUnitReporter(const HarnessConfig& config) : config_(config) {}
+
+  // Checks a finished input. Returns true if it was saved as a slow unit.
+  bool Check(const InputProfile& profile, absl::string_view input);
+
+  int slow_units_found() const { return slow_units_found_; }
+
+ private:
+  const HarnessConfig& config_;
+  int slow_units_found_ = 0;
+};
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_SLOW_UNIT_REPORTER_H
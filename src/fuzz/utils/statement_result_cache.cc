@@ -0,0 +1,98 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/statement_result_cache.h"
+
+#include <string>
+#include <utility>
+
+#include "absl/hash/hash.h"
+#include "absl/strings/str_format.h"
+
+namespace spanner_emulator_fuzzer {
+
+namespace {
+
+uint64_t HashStatement(absl::string_view statement) {
+  return absl::Hash<absl::string_view>()(statement);
+}
+
+}  // namespace
+
+StatementResultCache::StatementResultCache(int64_t max_entries,
+                                           int64_t max_bytes)
+    : max_entries_(max_entries), max_bytes_(max_bytes) {}
+
+int64_t StatementResultCache::EntryBytes(const Entry& entry) {
+  // The list node and the index slot, plus the message itself.
+  return sizeof(Entry) + 2 * sizeof(void*) +
+         sizeof(std::pair<uint64_t, void*>) + entry.result.message.capacity();
+}
+
+const StatementResult* StatementResultCache::Lookup(
+    absl::string_view statement) {
+  auto it = index_.find(HashStatement(statement));
+  if (it == index_.end() || it->second->statement_size != statement.size()) {
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return &it->second->result;
+}
+
+void StatementResultCache::Insert(absl::string_view statement,
+                                  StatementResult result) {
+  if (max_entries_ <= 0) {
+    return;
+  }
+  uint64_t hash = HashStatement(statement);
+  auto it = index_.find(hash);
+  if (it != index_.end()) {
+    bytes_ -= EntryBytes(*it->second);
+    entries_.erase(it->second);
+    index_.erase(it);
+  }
+
+  entries_.push_front(Entry{hash, statement.size(), std::move(result)});
+  index_[hash] = entries_.begin();
+  bytes_ += EntryBytes(entries_.front());
+  EvictToFit();
+}
+
+void StatementResultCache::EvictToFit() {
+  while (!entries_.empty() &&
+         (size() > max_entries_ || bytes_ > max_bytes_)) {
+    const Entry& oldest = entries_.back();
+    bytes_ -= EntryBytes(oldest);
+    index_.erase(oldest.hash);
+    entries_.pop_back();
+    ++evictions_;
+  }
+}
+
+double StatementResultCache::hit_rate() const {
+  int64_t lookups = hits_ + misses_;
+  return lookups == 0 ? 0.0 : static_cast<double>(hits_) / lookups;
+}
+
+std::string StatementResultCache::StatsString() const {
+  return absl::StrFormat(
+      "hits=%d misses=%d hit_rate=%.1f%% entries=%d bytes=%d evictions=%d",
+      hits_, misses_, 100 * hit_rate(), size(), bytes_, evictions_);
+}
+
+}  // namespace spanner_emulator_fuzzer
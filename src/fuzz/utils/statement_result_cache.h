@@ -0,0 +1,85 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_STATEMENT_RESULT_CACHE_H
+#define SRC_FUZZ_UTILS_STATEMENT_RESULT_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+
+namespace spanner_emulator_fuzzer {
+
+// The outcome of executing a statement against the emulator.
+struct StatementResult {
+  // A google::cloud::StatusCode, 0 on success.
+  int status_code = 0;
+  std::string message;
+};
+
+// Remembers what the emulator returned for recently executed statements, so
+// exact repeats produced by the mutator can skip the RPC. Entries are keyed by
+// a 64-bit hash of the rendered statement and evicted least recently used
+// first once either bound is reached. Not thread-safe.
+class StatementResultCache {
+ public:
+  // max_bytes bounds the memory held by cached error messages plus a fixed
+  // per-entry overhead.
+  StatementResultCache(int64_t max_entries, int64_t max_bytes);
+
+  // Returns the cached result of statement, or nullptr on a miss. The result
+  // is valid until the next call to Insert.
+  const StatementResult* Lookup(absl::string_view statement);
+  void Insert(absl::string_view statement, StatementResult result);
+
+  int64_t size() const { return entries_.size(); }
+  int64_t bytes() const { return bytes_; }
+  int64_t hits() const { return hits_; }
+  int64_t misses() const { return misses_; }
+  int64_t evictions() const { return evictions_; }
+  double hit_rate() const;
+
+  // "hits=... misses=... hit_rate=...% entries=... bytes=... evictions=..."
+  std::string StatsString() const;
+
+ private:
+  struct Entry {
+    uint64_t hash;
+    // Guards against hash collisions between statements of different lengths.
+    size_t statement_size;
+    StatementResult result;
+  };
+
+  static int64_t EntryBytes(const Entry& entry);
+  void EvictToFit();
+
+  int64_t max_entries_;
+  int64_t max_bytes_;
+  int64_t bytes_ = 0;
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+  int64_t evictions_ = 0;
+  // Most recently used first.
+  std::list<Entry> entries_;
+  absl::flat_hash_map<uint64_t, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_STATEMENT_RESULT_CACHE_H
@@ -0,0 +1,129 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/traffic_capture.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "zetasql/base/logging.h"
+#include "google/protobuf/message.h"
+#include "grpcpp/support/byte_buffer.h"
+#include "grpcpp/support/client_interceptor.h"
+#include "grpcpp/support/interceptor.h"
+#include "absl/time/clock.h"
+#include "src/fuzz/utils/traffic_log.h"
+
+namespace spanner_emulator_fuzzer {
+
+namespace {
+
+using ::grpc::experimental::ClientInterceptorFactoryInterface;
+using ::grpc::experimental::ClientRpcInfo;
+using ::grpc::experimental::InterceptionHookPoints;
+using ::grpc::experimental::Interceptor;
+using ::grpc::experimental::InterceptorBatchMethods;
+
+TrafficLogWriter* capture_log = nullptr;
+absl::Time capture_start;
+std::atomic<uint64_t> next_call_id{0};
+
+std::string ByteBufferToString(grpc::ByteBuffer* buffer) {
+  std::vector<grpc::Slice> slices;
+  std::string out;
+  if (!buffer->Dump(&slices).ok()) return out;
+  for (const grpc::Slice& slice : slices) {
+    out.append(reinterpret_cast<const char*>(slice.begin()), slice.size());
+  }
+  return out;
+}
+
+class CaptureInterceptor : public Interceptor {
+ public:
+  explicit CaptureInterceptor(ClientRpcInfo* info)
+      : method_(info->method()), call_id_(next_call_id++) {}
+
+  void Intercept(InterceptorBatchMethods* methods) override {
+    if (methods->QueryInterceptionHookPoint(
+            InterceptionHookPoints::PRE_SEND_MESSAGE)) {
+      Record(TrafficRecord::kRequest,
+             ByteBufferToString(methods->GetSerializedSendMessage()));
+    }
+    if (methods->QueryInterceptionHookPoint(
+            InterceptionHookPoints::POST_RECV_MESSAGE)) {
+      // nullptr when the receive failed, e.g. at the end of a stream.
+      auto* message =
+          static_cast<google::protobuf::Message*>(methods->GetRecvMessage());
+      if (message != nullptr) {
+        Record(TrafficRecord::kResponse, message->SerializeAsString());
+      }
+    }
+    methods->Proceed();
+  }
+
+ private:
+  void Record(TrafficRecord::Kind kind, std::string payload) {
+    TrafficRecord record;
+    record.kind = kind;
+    record.call_id = call_id_;
+    record.method = method_;
+    record.timestamp = absl::Now() - capture_start;
+    record.payload = std::move(payload);
+    capture_log->Write(record);
+  }
+
+  std::string method_;
+  uint64_t call_id_;
+};
+
+class CaptureInterceptorFactory : public ClientInterceptorFactoryInterface {
+ public:
+  Interceptor* CreateClientInterceptor(ClientRpcInfo* info) override {
+    return new CaptureInterceptor(info);
+  }
+};
+
+}  // namespace
+
+bool StartTrafficCapture(const std::string& path) {
+  if (capture_log != nullptr) {
+    LOG(ERROR) << "Traffic capture was already started";
+    return false;
+  }
+  std::unique_ptr<TrafficLogWriter> log = TrafficLogWriter::Open(path);
+  if (!log) {
+    LOG(ERROR) << "Cannot create traffic log " << path;
+    return false;
+  }
+  capture_log = log.release();
+  capture_start = absl::Now();
+  grpc::experimental::RegisterGlobalClientInterceptorFactory(
+      new CaptureInterceptorFactory);
+  std::atexit(FlushTrafficCapture);
+  LOG(INFO) << "Capturing emulator traffic to " << path;
+  return true;
+}
+
+void FlushTrafficCapture() {
+  if (capture_log != nullptr) {
+    capture_log->Flush();
+  }
+}
+
+}  // namespace spanner_emulator_fuzzer
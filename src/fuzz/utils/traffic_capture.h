@@ -0,0 +1,37 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_TRAFFIC_CAPTURE_H
+#define SRC_FUZZ_UTILS_TRAFFIC_CAPTURE_H
+
+#include <string>
+
+namespace spanner_emulator_fuzzer {
+
+// Records every request and response exchanged over gRPC channels created
+// after this call into a traffic log at path, which traffic_replay sends
+// straight back to an emulator without the client library. Uses a global
+// client interceptor, so it can only be started once per process and must be
+// started before the first channel is created. Returns false if the log
+// cannot be created or capture was already started.
+bool StartTrafficCapture(const std::string& path);
+
+// Writes buffered records to disk. Also runs at exit.
+void FlushTrafficCapture();
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_TRAFFIC_CAPTURE_H
@@ -0,0 +1,97 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/traffic_identifiers.h"
+
+#include <string>
+#include <vector>
+
+namespace spanner_emulator_fuzzer {
+
+namespace protobuf = ::google::protobuf;
+
+void CollectIdentifiers(const protobuf::Message& message,
+                        std::vector<std::string>* ids) {
+  const protobuf::Descriptor* descriptor = message.GetDescriptor();
+  const protobuf::Reflection* reflection = message.GetReflection();
+  if (descriptor->full_name() == "google.spanner.v1.Session") {
+    ids->push_back(reflection->GetString(
+        message, descriptor->FindFieldByName("name")));
+  } else if (descriptor->full_name() == "google.spanner.v1.Transaction") {
+    ids->push_back(
+        reflection->GetString(message, descriptor->FindFieldByName("id")));
+  }
+  std::vector<const protobuf::FieldDescriptor*> fields;
+  reflection->ListFields(message, &fields);
+  for (const protobuf::FieldDescriptor* field : fields) {
+    if (field->cpp_type() != protobuf::FieldDescriptor::CPPTYPE_MESSAGE) {
+      continue;
+    }
+    if (field->is_repeated()) {
+      for (int i = 0; i < reflection->FieldSize(message, field); ++i) {
+        CollectIdentifiers(reflection->GetRepeatedMessage(message, field, i),
+                           ids);
+      }
+    } else {
+      CollectIdentifiers(reflection->GetMessage(message, field), ids);
+    }
+  }
+}
+
+bool IsIdentifierField(const protobuf::FieldDescriptor* field) {
+  const std::string& message = field->containing_type()->full_name();
+  if (field->name() == "session" || field->name() == "transaction_id") {
+    return true;
+  }
+  if (field->name() == "id") {
+    return message == "google.spanner.v1.TransactionSelector";
+  }
+  if (field->name() == "name") {
+    return message == "google.spanner.v1.Session" ||
+           message == "google.spanner.v1.GetSessionRequest" ||
+           message == "google.spanner.v1.DeleteSessionRequest";
+  }
+  return false;
+}
+
+void RemapIdentifiers(const IdentifierMap& ids, protobuf::Message* message) {
+  const protobuf::Reflection* reflection = message->GetReflection();
+  std::vector<const protobuf::FieldDescriptor*> fields;
+  reflection->ListFields(*message, &fields);
+  for (const protobuf::FieldDescriptor* field : fields) {
+    if (field->cpp_type() == protobuf::FieldDescriptor::CPPTYPE_STRING) {
+      if (field->is_repeated() || !IsIdentifierField(field)) {
+        continue;
+      }
+      auto it = ids.find(reflection->GetString(*message, field));
+      if (it != ids.end()) {
+        reflection->SetString(message, field, it->second);
+      }
+    } else if (field->cpp_type() ==
+               protobuf::FieldDescriptor::CPPTYPE_MESSAGE) {
+      if (field->is_repeated()) {
+        for (int i = 0; i < reflection->FieldSize(*message, field); ++i) {
+          RemapIdentifiers(ids,
+                           reflection->MutableRepeatedMessage(message, field, i));
+        }
+      } else {
+        RemapIdentifiers(ids, reflection->MutableMessage(message, field));
+      }
+    }
+  }
+}
+
+}  // namespace spanner_emulator_fuzzer
@@ -0,0 +1,53 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_TRAFFIC_IDENTIFIERS_H
+#define SRC_FUZZ_UTILS_TRAFFIC_IDENTIFIERS_H
+
+#include <string>
+#include <vector>
+
+#include "google/protobuf/descriptor.h"
+#include "google/protobuf/message.h"
+#include "absl/container/flat_hash_map.h"
+
+namespace spanner_emulator_fuzzer {
+
+// Emulator assigned identifiers, mapped from their captured to their replayed
+// values.
+using IdentifierMap = absl::flat_hash_map<std::string, std::string>;
+
+// Whether field holds a session name or transaction id in a request: the
+// session of data requests, the transaction id of a TransactionSelector,
+// CommitRequest and RollbackRequest, and the name of a session, e.g. in
+// BatchCreateSessions, GetSession and DeleteSession.
+bool IsIdentifierField(const google::protobuf::FieldDescriptor* field);
+
+// Appends the session names and transaction ids in a response, in field
+// order.
+void CollectIdentifiers(const google::protobuf::Message& message,
+                        std::vector<std::string>* ids);
+
+// Replaces the session names and transaction ids in a request that were
+// captured with the ones the emulator assigned during the replay. Other
+// strings, such as SQL text or key values, are never rewritten even when they
+// happen to match a captured identifier.
+void RemapIdentifiers(const IdentifierMap& ids,
+                      google::protobuf::Message* message);
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_TRAFFIC_IDENTIFIERS_H
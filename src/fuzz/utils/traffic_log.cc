@@ -0,0 +1,143 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "src/fuzz/utils/traffic_log.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace spanner_emulator_fuzzer {
+
+namespace {
+
+constexpr char kMagic[] = "SPNRTRC1";
+constexpr size_t kMagicSize = sizeof(kMagic) - 1;
+
+// Entries of the log. Method definitions intern a method name so the records
+// that follow can refer to it by id.
+enum EntryType : uint8_t {
+  kMethodDefinition = 0,
+  kRecord = 1,
+};
+
+void PutVarint(std::string* out, uint64_t value) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+void PutBytes(std::string* out, const std::string& bytes) {
+  PutVarint(out, bytes.size());
+  out->append(bytes);
+}
+
+bool GetVarint(std::istream& in, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    int byte = in.get();
+    if (byte == EOF) return false;
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) return true;
+  }
+  return false;
+}
+
+bool GetBytes(std::istream& in, std::string* bytes) {
+  uint64_t size;
+  if (!GetVarint(in, &size)) return false;
+  bytes->resize(size);
+  return static_cast<bool>(in.read(&(*bytes)[0], size)) || size == 0;
+}
+
+}  // namespace
+
+std::unique_ptr<TrafficLogWriter> TrafficLogWriter::Open(
+    const std::string& path) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  if (!out) return nullptr;
+  out.write(kMagic, kMagicSize);
+  return std::unique_ptr<TrafficLogWriter>(new TrafficLogWriter(std::move(out)));
+}
+
+void TrafficLogWriter::Write(const TrafficRecord& record) {
+  std::string entry;
+  absl::MutexLock lock(&mu_);
+  auto method = method_ids_.find(record.method);
+  if (method == method_ids_.end()) {
+    method = method_ids_.emplace(record.method, method_ids_.size()).first;
+    entry.push_back(kMethodDefinition);
+    PutVarint(&entry, method->second);
+    PutBytes(&entry, record.method);
+  }
+  entry.push_back(kRecord);
+  entry.push_back(record.kind);
+  PutVarint(&entry, record.call_id);
+  PutVarint(&entry, method->second);
+  PutVarint(&entry, absl::ToInt64Nanoseconds(record.timestamp));
+  PutBytes(&entry, record.payload);
+  out_.write(entry.data(), entry.size());
+}
+
+void TrafficLogWriter::Flush() {
+  absl::MutexLock lock(&mu_);
+  out_.flush();
+}
+
+std::unique_ptr<TrafficLogReader> TrafficLogReader::Open(
+    const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  char magic[kMagicSize];
+  if (!in.read(magic, kMagicSize) ||
+      std::string(magic, kMagicSize) != kMagic) {
+    return nullptr;
+  }
+  return std::unique_ptr<TrafficLogReader>(new TrafficLogReader(std::move(in)));
+}
+
+bool TrafficLogReader::Next(TrafficRecord* record) {
+  while (true) {
+    int type = in_.get();
+    if (type == EOF) return false;
+
+    if (type == kMethodDefinition) {
+      uint64_t id;
+      std::string method;
+      if (!GetVarint(in_, &id) || !GetBytes(in_, &method)) return false;
+      if (id >= methods_.size()) methods_.resize(id + 1);
+      methods_[id] = std::move(method);
+      continue;
+    }
+
+    int kind = in_.get();
+    uint64_t method_id;
+    uint64_t timestamp_nanos;
+    if (type != kRecord || kind == EOF ||
+        !GetVarint(in_, &record->call_id) || !GetVarint(in_, &method_id) ||
+        !GetVarint(in_, &timestamp_nanos) || !GetBytes(in_, &record->payload) ||
+        method_id >= methods_.size()) {
+      return false;
+    }
+    record->kind = static_cast<TrafficRecord::Kind>(kind);
+    record->method = methods_[method_id];
+    record->timestamp = absl::Nanoseconds(timestamp_nanos);
+    return true;
+  }
+}
+
+}  // namespace spanner_emulator_fuzzer
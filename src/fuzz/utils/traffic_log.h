@@ -0,0 +1,86 @@
+//
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef SRC_FUZZ_UTILS_TRAFFIC_LOG_H
+#define SRC_FUZZ_UTILS_TRAFFIC_LOG_H
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace spanner_emulator_fuzzer {
+
+// One serialized message sent to or received from the emulator.
+struct TrafficRecord {
+  enum Kind : uint8_t {
+    kRequest = 0,
+    kResponse = 1,
+  };
+
+  Kind kind = kRequest;
+  // Identifies the RPC, shared by its request and response messages.
+  uint64_t call_id = 0;
+  // Full gRPC method name, e.g. "/google.spanner.v1.Spanner/ExecuteSql".
+  std::string method;
+  // Time since the capture started.
+  absl::Duration timestamp;
+  std::string payload;
+};
+
+// Appends TrafficRecords to a compact binary log: a magic header followed by
+// varint encoded records, with method names interned on first use.
+// Thread-safe, since gRPC calls complete on several threads.
+class TrafficLogWriter {
+ public:
+  // Returns nullptr if the file cannot be created.
+  static std::unique_ptr<TrafficLogWriter> Open(const std::string& path);
+
+  void Write(const TrafficRecord& record);
+  void Flush();
+
+ private:
+  explicit TrafficLogWriter(std::ofstream out) : out_(std::move(out)) {}
+
+  absl::Mutex mu_;
+  std::ofstream out_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<std::string, uint64_t> method_ids_ ABSL_GUARDED_BY(mu_);
+};
+
+// Reads back the records of a log written by TrafficLogWriter, in order.
+class TrafficLogReader {
+ public:
+  // Returns nullptr if the file cannot be opened or is not a traffic log.
+  static std::unique_ptr<TrafficLogReader> Open(const std::string& path);
+
+  // Returns false at the end of the log or on a truncated record.
+  bool Next(TrafficRecord* record);
+
+ private:
+  explicit TrafficLogReader(std::ifstream in) : in_(std::move(in)) {}
+
+  std::ifstream in_;
+  std::vector<std::string> methods_;
+};
+
+}  // namespace spanner_emulator_fuzzer
+
+#endif  // SRC_FUZZ_UTILS_TRAFFIC_LOG_H